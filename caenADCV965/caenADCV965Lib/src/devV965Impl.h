@@ -0,0 +1,354 @@
+#ifndef DEVV965IMPL_H
+#define DEVV965IMPL_H
+
+#include <stdio.h>
+
+#include <longoutRecord.h>
+#include <longinRecord.h>
+#include <aiRecord.h>
+#include <waveformRecord.h>
+#include <aaiRecord.h>
+#include <alarm.h>
+#include <dbAccess.h>                           /* For S_db_badField constant macro */
+#include <devSup.h>                             /* For device support entry table declarations */
+#include <recGbl.h> 
+#include <dbFldTypes.h>
+#       ifndef EPICS_313
+#       include <epicsExport.h> /* 3.14.4 Port */
+#       endif
+
+#include "drvV965.h"
+
+/*
+ * file:                devV965Impl.h
+ * purpose:             EPICS Device Support for CAEN V965 VME Charge Integrating Dual Range ADC
+ *                      Templates for the dsets; devV965.cc of each module
+ *                      instantiates them under its own dset names
+ * created:             28-Oct-2005
+ *                      Oak Ridge National Laboratory
+ *
+ * revision history:
+ *   28-Oct-2005        David H Thompson        initial version
+ *   17-Aug-2006        Doug Murray             updated
+ */
+
+///////////////////////////
+//                       //
+// ai device support     //
+//                       //
+///////////////////////////
+
+template <class Layout>
+struct AiDset
+        {
+        /*
+         * analog input dset
+         */
+        long number;
+        DEVSUPFUN dev_report;
+        DEVSUPFUN init;
+        DEVSUPFUN init_record;                  /*returns: (-1,0)=>(failure,success)*/
+        DEVSUPFUN get_ioint_info;
+        DEVSUPFUN read_ai;                      /*(0,2)=> success and convert,don't convert)*/
+                                                /* if convert then raw value stored in rval */
+        DEVSUPFUN special_linconv;
+                                                /* Since this is c++ I can try this packagin scheme. */
+        static long InitRecord( aiRecord *pRec);
+        static long GetIOIntInfo( int cmd, aiRecord *pRec, IOSCANPVT *ppvt);
+        static long ReadAi( aiRecord *pRec);
+        };
+
+template <class Layout>
+long AiDset<Layout>::
+InitRecord( aiRecord *pRec)
+        {
+
+        //pRec->linr=0;
+
+        if( drvCaenV965Board<Layout>::recordInit( &pRec->inp, (dbCommon *)pRec) != 0)
+                {
+                char message[120];
+
+                sprintf( message, "dev%sAI (init_record) Illegal INP field", Layout::name());
+                recGblRecordError(S_db_badField, (void *)pRec, message);
+                return S_db_badField;
+                }
+
+        // If we are reading the high register we use this scale
+        if( pRec->inp.value.vmeio.parm[0] == 'H')
+                pRec->eslo=200e-15;             // menuConvertSLOPE overrides
+            else
+                pRec->eslo=25e-15;              // menuConvertSLOPE overrides
+        return 0;
+        }
+
+template <class Layout>
+long AiDset<Layout>::
+GetIOIntInfo( int cmd, aiRecord *pRec, IOSCANPVT *ppvt)
+        {
+
+        return drvCaenV965Board<Layout>::getIOIntInfo( cmd, &pRec->inp, ppvt);
+        }
+
+template <class Layout>
+long AiDset<Layout>::
+ReadAi( aiRecord *pRec)
+        {
+        int rv;
+
+        rv = drvCaenV965Board<Layout>::getValue( &pRec->inp, &pRec->rval);
+
+        // if( pRec->linr == menuConvertNO_CONVERSION)
+        //        {
+        //        pRec->val=pRec->rval;
+        //        if( rv == OK)
+        //              rv=2;
+        //        }
+        return rv; // dont convert 
+        }
+
+///////////////////////////
+//                       //
+// longin device support //
+//                       //
+///////////////////////////
+template <class Layout>
+struct LongInDset
+        {
+        long number;
+        DEVSUPFUN dev_report;
+        DEVSUPFUN init;
+        DEVSUPFUN init_record;                  /* returns: (-1,0)=>(failure,success)*/
+        DEVSUPFUN get_ioint_info;
+        DEVSUPFUN read_longin;                  /* returns: (-1,0)=>(failure,success)*/
+        static long InitRecord( longinRecord *pAI);
+        static long GetIOIntInfo( int cmd, longinRecord *pAI, IOSCANPVT *ppvt);
+        static long ReadLongin( longinRecord *pAI);
+        };
+
+template <class Layout>
+long LongInDset<Layout>::
+InitRecord( longinRecord *pRec)
+        {
+
+        if( drvCaenV965Board<Layout>::recordInit( &pRec->inp,(dbCommon *)pRec) != 0)
+                {
+                char message[120];
+
+                sprintf( message, "dev%sLongin (init_record) Illegal INP field", Layout::name());
+                recGblRecordError( S_db_badField, (void *)pRec, message);
+                return S_db_badField;
+                }
+        return 0;
+        }
+
+template <class Layout>
+long LongInDset<Layout>::
+GetIOIntInfo( int cmd, longinRecord *pRec, IOSCANPVT *ppvt)
+        {
+
+        return drvCaenV965Board<Layout>::getIOIntInfo( cmd, &pRec->inp, ppvt);
+        }
+
+template <class Layout>
+long LongInDset<Layout>::
+ReadLongin( longinRecord *pRec)
+        {
+
+        return drvCaenV965Board<Layout>::getValue( &pRec->inp, &pRec->val);
+        }
+
+////////////////////////////
+//                        //
+// longout device support //
+//                        //
+////////////////////////////
+template <class Layout>
+struct LongOutDset
+        {
+        long number;
+        DEVSUPFUN dev_report;
+        DEVSUPFUN init;
+        DEVSUPFUN init_record;                  /*returns: (-1,0)=>(failure,success) */
+        DEVSUPFUN get_ioint_info;
+        DEVSUPFUN write_longout;                /* (-1,0)=>(failure,success */
+        static long InitRecord(longoutRecord *pRec);
+        static long GetIOIntInfo(int cmd, longoutRecord *pRec, IOSCANPVT *ppvt);
+        static long writeLongout(longoutRecord *pRec);
+        };
+
+template <class Layout>
+long LongOutDset<Layout>::
+InitRecord( longoutRecord *pRec)
+        {
+        
+        if( drvCaenV965Board<Layout>::recordInit( &pRec->out, (dbCommon *)pRec) != 0)
+                {
+                char message[120];
+
+                sprintf( message, "dev%sLongout (init_record) Illegal OUT field", Layout::name());
+                recGblRecordError( S_db_badField, (void *)pRec, message);
+                return S_db_badField;
+                }
+        return 0;
+        }
+
+template <class Layout>
+long LongOutDset<Layout>::
+GetIOIntInfo(int cmd, longoutRecord *pRec, IOSCANPVT *ppvt)
+        {
+
+        return drvCaenV965Board<Layout>::getIOIntInfo( cmd, &pRec->out, ppvt);
+        }
+
+template <class Layout>
+long LongOutDset<Layout>::
+writeLongout(longoutRecord *pRec)
+        {
+
+        return drvCaenV965Board<Layout>::putValue( &pRec->out, pRec->val);
+        }
+
+/////////////////////////////
+//                         //
+// waveform device support //
+//                         //
+/////////////////////////////
+
+// Shared by waveform and aai: @B.. is the board's channels, @P.. the states of a cycle,
+// @W.. and @Y.. the event ring
+template <class Layout>
+long caenV965InitArray( dbCommon *pRec, DBLINK *pLink, short ftvl, const char *pType)
+        {
+        const char *pparm = pLink->value.vmeio.parm;
+
+        if( pLink->type != VME_IO || pparm == NULL || ( pparm[0] != 'B' && pparm[0] != 'P' && pparm[0] != 'W' && pparm[0] != 'Y') || ftvl != DBF_LONG)
+                {
+                char message[120];
+
+                sprintf( message, "dev%s%s (init_record) INP must be @B.., @P.., @W.. or @Y.. and FTVL LONG", Layout::name(), pType);
+                recGblRecordError( S_db_badField, (void *)pRec, message);
+                return S_db_badField;
+                }
+
+        if( drvCaenV965Board<Layout>::recordInit( pLink, pRec) != 0)
+                {
+                char message[120];
+
+                sprintf( message, "dev%s%s (init_record) Illegal INP field", Layout::name(), pType);
+                recGblRecordError( S_db_badField, (void *)pRec, message);
+                return S_db_badField;
+                }
+
+        drvCaenV965Cursor *pCursor = new drvCaenV965Cursor;
+        pCursor->next = 0;
+        pCursor->clears = 0;
+        pRec->dpvt = pCursor;
+        return 0;
+        }
+
+template <class Layout>
+long caenV965ReadArray( dbCommon *pRec, DBLINK *pLink, void *bptr, epicsUInt32 nelm, epicsUInt32 *pNord)
+        {
+        int n;
+
+        if( pLink->value.vmeio.parm[0] == 'B')
+                {
+                bool stale;
+
+                n = drvCaenV965Board<Layout>::getBoard( pLink, (epicsInt32 *)bptr, nelm, &stale);
+                if( n >= 0 && stale)
+                        recGblSetSevr( pRec, READ_ALARM, INVALID_ALARM);
+                }
+            else if( pLink->value.vmeio.parm[0] == 'P')
+                n = drvCaenV965Board<Layout>::getPattern( pLink, (epicsInt32 *)bptr, nelm);
+            else
+                n = drvCaenV965Board<Layout>::getHistory( pLink, (drvCaenV965Cursor *)pRec->dpvt, (epicsInt32 *)bptr, nelm);
+        if( n < 0)
+                return -1;
+        *pNord = n;
+        return 0;
+        }
+
+template <class Layout>
+struct WaveformDset
+        {
+        long number;
+        DEVSUPFUN dev_report;
+        DEVSUPFUN init;
+        DEVSUPFUN init_record;                  /* returns: (-1,0)=>(failure,success)*/
+        DEVSUPFUN get_ioint_info;
+        DEVSUPFUN read_wf;                      /* returns: (-1,0)=>(failure,success)*/
+        static long InitRecord( waveformRecord *pRec);
+        static long GetIOIntInfo( int cmd, waveformRecord *pRec, IOSCANPVT *ppvt);
+        static long ReadWf( waveformRecord *pRec);
+        };
+
+template <class Layout>
+long WaveformDset<Layout>::
+InitRecord( waveformRecord *pRec)
+        {
+
+        return caenV965InitArray<Layout>(( dbCommon *)pRec, &pRec->inp, pRec->ftvl, "Waveform");
+        }
+
+template <class Layout>
+long WaveformDset<Layout>::
+GetIOIntInfo( int cmd, waveformRecord *pRec, IOSCANPVT *ppvt)
+        {
+
+        return drvCaenV965Board<Layout>::getIOIntInfo( cmd, &pRec->inp, ppvt);
+        }
+
+template <class Layout>
+long WaveformDset<Layout>::
+ReadWf( waveformRecord *pRec)
+        {
+
+        return caenV965ReadArray<Layout>(( dbCommon *)pRec, &pRec->inp, pRec->bptr, pRec->nelm, &pRec->nord);
+        }
+
+////////////////////////
+//                    //
+// aai device support //
+//                    //
+////////////////////////
+template <class Layout>
+struct AaiDset
+        {
+        long number;
+        DEVSUPFUN dev_report;
+        DEVSUPFUN init;
+        DEVSUPFUN init_record;                  /* returns: (-1,0)=>(failure,success)*/
+        DEVSUPFUN get_ioint_info;
+        DEVSUPFUN read_aai;                     /* returns: (-1,0)=>(failure,success)*/
+        static long InitRecord( aaiRecord *pRec);
+        static long GetIOIntInfo( int cmd, aaiRecord *pRec, IOSCANPVT *ppvt);
+        static long ReadAai( aaiRecord *pRec);
+        };
+
+template <class Layout>
+long AaiDset<Layout>::
+InitRecord( aaiRecord *pRec)
+        {
+
+        return caenV965InitArray<Layout>(( dbCommon *)pRec, &pRec->inp, pRec->ftvl, "Aai");
+        }
+
+template <class Layout>
+long AaiDset<Layout>::
+GetIOIntInfo( int cmd, aaiRecord *pRec, IOSCANPVT *ppvt)
+        {
+
+        return drvCaenV965Board<Layout>::getIOIntInfo( cmd, &pRec->inp, ppvt);
+        }
+
+template <class Layout>
+long AaiDset<Layout>::
+ReadAai( aaiRecord *pRec)
+        {
+
+        return caenV965ReadArray<Layout>(( dbCommon *)pRec, &pRec->inp, pRec->bptr, pRec->nelm, &pRec->nord);
+        }
+
+#endif
@@ -1,9 +1,14 @@
 // This file defines interfaces avaliable to the vxWorks shell and to record processing.
+// It is shared by caenADCV965 (16 channels) and CaenADCV965_8 (8 channel V965A).
+
+#ifndef DRVV965_H
+#define DRVV965_H
 
 #include "dbScan.h"
 #include "link.h" // from epics base:
 
 #include <epicsEvent.h>
+#include <epicsThread.h>
 #include <epicsTypes.h>
 
 /******************************************************\
@@ -26,36 +31,118 @@ extern "C"
 
         // Reset the state counter
         int drvCaenV965Wait( int board);
+
+        // Read boards first..last with one chained block transfer
+        int caenV965CbltConfig( int first, int last, int cbltAddr);
+
+        // A board in memory, for timing the readout without hardware
+        int caenV965SimConfig( int board, int states);
+        int caenV965SimBench( int board, int events);
+        int caenV965SimReplay( int board, const char *file);
+
+        // The same for the 8 channel boards
+        int caenV965_8Probe();
+        int caenV965_8Config( int board, size_t base, int addrSpace, int vector, int level, int states);
+        int drvCaenV965_8Report( int level);
+        int drvCaenV965_8SetState( int board , int state);
+        int drvCaenV965_8Wait( int board);
+        int caenV965_8CbltConfig( int first, int last, int cbltAddr);
+        int caenV965_8SimConfig( int board, int states);
+        int caenV965_8SimBench( int board, int events);
+        int caenV965_8SimReplay( int board, const char *file);
         }
 
 // Config:
 #define NUM_BOARDS (20)
-#define CAEN_NUM_CHAN (16)
 enum ADC_RANGE
         {
         ADC_HI = 0,
         ADC_LO = 1
         };
 
+// The output buffer window is 0x800 bytes; that is the most we move per block transfer.
+#define CAEN_BLOCK_WORDS (0x200)
+// Upper bound on block transfers per interrupt before the board is re-armed.
+#define CAEN_MAX_BLOCKS (8)
+// Decoded events kept per board for waveform records, must be a power of 2.
+#define CAEN_RING_EVENTS (1024)
+// Output buffer words a simulated board can hold
+#define CAEN_SIM_WORDS (0x10000)
+// chanData status and ring status for a channel that was not in the event
+#define CAEN_STATUS_ABSENT (4)
+// Above this the low range is not used
+#define CAEN_SPLICE_LIMIT (3840)
+// Gain of the high range into low range counts, 4096 is 1 count/count
+#define CAEN_GAIN_DEFAULT (8<<12)
+// Calibration uses low range values from here to CAEN_SPLICE_LIMIT
+#define CAEN_CAL_LO_MIN (1024)
+
+// Per-record position in the event ring, kept by waveform device support
+struct drvCaenV965Cursor
+        {
+        size_t next; // Next ring entry this record has not seen
+        size_t clears; // Histogram clears seen
+        };
+
+
+//
+// What differs between the board variants.
+// The datum word carries the channel number starting at CHANNEL_SHIFT and the
+// range bit at RANGE_BIT. The threshold memory at 0x1080 is 32 words either
+// way; the 8 channel board uses every other one (THRESHOLD_STRIDE).
+//
+struct caenV965Layout16
+        {
+        enum
+                {
+                NUM_CHAN = 16,
+                THRESHOLD_STRIDE = 1,
+                CHANNEL_SHIFT = 17,
+                RANGE_BIT = 1<<16
+                };
+        static const char *name() { return "CaenV965"; }
+        };
+
+struct caenV965Layout8
+        {
+        enum
+                {
+                NUM_CHAN = 8,
+                THRESHOLD_STRIDE = 2,
+                CHANNEL_SHIFT = 18,
+                RANGE_BIT = 1<<17
+                };
+        static const char *name() { return "CaenV965_8"; }
+        };
 
 // These are declared in drvV965p.h
-class drvCaenV965Registers;
+template <class Layout> class drvCaenV965RegisterMap;
+struct epicsDmaInfo;
 
 // This is the low level device data structure.
 // We create one of these per board.
-class drvCaenV965Device
+// The implementation is in drvV965Impl.h and is instantiated once per layout.
+template <class Layout>
+class drvCaenV965Board
         {
 
         public:
-                drvCaenV965Device();
+                typedef drvCaenV965RegisterMap<Layout> Registers;
+
+                drvCaenV965Board();
 
                 /* Initialize the board */
 
                 static long init();
                 static long report( int level);
                 static int caenV965Config( int board, size_t base, int addrSpace, int vector, int level, int states);
+                static int cbltConfig( int first, int last, int cbltAddr);
+                static int simConfig( int board, int states);
+                static int simBench( int board, int events);
+                static int simReplay( int board, const char *file);
 
                 static void isr( void *pDev);
+                static void readoutTask( void *pDev);
                 static void atExit( void *arg);
                 int readOutputBuffer();
                 void show( int level);
@@ -68,6 +155,12 @@ class drvCaenV965Device
                 int getValue( int signal, const char *parm , epicsInt32 *value); // Return status
                 static int getValue(DBLINK *pLink, epicsInt32  *value); // Return status
                 static long getIOIntInfo( int cmd, DBLINK *pLink, IOSCANPVT *ppvt);
+                int getHistory( int signal, const char *parm, drvCaenV965Cursor *pCursor, epicsInt32 *pBuf, int nelm); // Returns count or -1
+                static int getHistory( DBLINK *pLink, drvCaenV965Cursor *pCursor, epicsInt32 *pBuf, int nelm);
+                int getBoard( int signal, const char *parm, epicsInt32 *pBuf, int nelm, bool *pStale); // Returns count or -1
+                static int getBoard( DBLINK *pLink, epicsInt32 *pBuf, int nelm, bool *pStale);
+                int getPattern( int signal, const char *parm, epicsInt32 *pBuf, int nelm); // Returns count or -1
+                static int getPattern( DBLINK *pLink, epicsInt32 *pBuf, int nelm);
                 void setState( int newState);
                 long wait()
                         {
@@ -75,17 +168,98 @@ class drvCaenV965Device
                         return epicsEventWait( wakeupCall);
                         }
 
-                static drvCaenV965Device *getV965Handle( int board);
+                static drvCaenV965Board *getV965Handle( int board);
 
         private:
 
-                drvCaenV965Registers *pBoard;
+                void drain();
+                void readoutGroup();
+                static int setupGroup();
+                int readBlock( unsigned long *pBuf, int maxWords);
+                int dispatch( const unsigned long *pBuf, int nWords);
+
+                // The output buffer of a simulated board
+                struct simFifo
+                        {
+                        unsigned long *pWords; // CAEN_SIM_WORDS long
+                        size_t head; // Next word to read
+                        size_t tail; // Next word to write
+                        unsigned long counter; // Board event counter
+                        unsigned long seed;
+                        };
+                static drvCaenV965Board *getSimHandle( int board);
+                int simRead( unsigned long *pBuf, int maxWords);
+                bool simPush( unsigned long word);
+                void simEvent();
+                void suppress( int bits, bool enable);
+                double simRun();
+                void simResult( const char *what, size_t events, unsigned long words, double seconds);
+                int decode( const unsigned long *pBuf, int nWords);
+                long splice( int signal, int hi, int hiStatus, int lo, int loStatus);
+                void calibrate();
+
+                // What a record sees of one channel/range
+                struct chanSample
+                        {
+                        unsigned short data;
+                        unsigned short status;
+                        unsigned long event;
+                        long value; // The channel spliced, the same in both ranges
+                        };
+                void publish();
+                void readChannel( int signal, chanSample *pSample, unsigned long *pEvent);
+                void readChannels( int first, int count, chanSample ( *pSample)[2], unsigned long *pEvent);
+
+                // One channel in one state of the cycle
+                struct stateSample
+                        {
+                        unsigned short data[2];
+                        unsigned short status[2]; // As chanData status, CAEN_STATUS_ABSENT if not seen
+                        long value; // Spliced
+                        };
+                int stateCount() { return numStates > 0 ? numStates : 1; }
+                void startScan();
+                static void scanComplete( void *pDev, IOSCANPVT pvt, int prio);
+
+                // One decoded event as kept in the ring
+                struct ringEvent
+                        {
+                        unsigned long event; // The value of event the data was stamped with
+                        unsigned long counter; // Event counter from the board's EOB word
+                        int state; // currentState when the trigger arrived
+                        unsigned short data[Layout::NUM_CHAN][2];
+                        unsigned short status[Layout::NUM_CHAN][2]; // As chanData status
+                        long value[Layout::NUM_CHAN]; // Spliced
+                        };
+
+                Registers *pBoard;
                                         // to end up invalid.
+                size_t base; // VME address of the board, for block transfers
+                int addrSpace; // 24 or 32
 
                 // Process sync
                 IOSCANPVT ioscanpvt;
                 epicsEventId wakeupCall; // Set at the same time as scanIoRequest
 
+                // Readout: the ISR only disarms the board and signals readoutEvent,
+                // readoutTask drains the output buffer and decodes it.
+                epicsEventId readoutEvent;
+                epicsThreadId readoutThread;
+                unsigned long *pBlock; // CAEN_BLOCK_WORDS long
+                struct epicsDmaInfo *dmaId; // NULL => single cycle reads
+                simFifo *pSim; // NULL => a real board
+                unsigned long interruptCount;
+                unsigned long blockCount;
+                unsigned long wordCount;
+                unsigned long dmaErrors;
+
+                // Event ring; written only by the readout thread, read lock free.
+                // ringHead counts events ever published, entry i lives in pRing[i % CAEN_RING_EVENTS].
+                ringEvent *pRing;
+                size_t ringHead;
+                ringEvent building; // The event being decoded
+                size_t histClears; // Bumped to zero every histogram on the board; atomic
+
                 unsigned long event; // This is not the event counter on board
                                         // but rather is maintained by the ISR
                 unsigned char int_vector;
@@ -96,14 +270,60 @@ class drvCaenV965Device
                         unsigned short status; // 1=>under 2=over 0=normal
                         unsigned long event; // A copy of event when ISR last read this value
                         long gain; // Splice the high into the top of the low range - Only high channel
-                                        // - 0 = no adjustment
+                                        // - 0 = CAEN_GAIN_DEFAULT
                                         // 4096 is 1 count/count
+                        long offset; // Low range counts added to the high range - Only high channel
 
                         unsigned short threshold; // The zero offset.
-                        }chanData[CAEN_NUM_CHAN][2];
+                        }chanData[Layout::NUM_CHAN][2];
 
-                int sampleState[CAEN_NUM_CHAN]; // When state is this then store the data
+                // chanData belongs to the readout thread. At the end of each cycle
+                // its data goes into one of three snapshots; a record scan reads
+                // snapCurrent, or snapPinned while an I/O Intr scan is running,
+                // which the readout thread never writes. seq is odd during a write.
+                struct snapshot
+                        {
+                        size_t seq;
+                        unsigned long event;
+                        chanSample chan[Layout::NUM_CHAN][2];
+                        stateSample *pStates; // stateCount() * NUM_CHAN, by state then channel
+                        }snapshots[3];
+                int snapCurrent;
+                int snapPinned; // -1 => no scan running
+                int scanBusy;
+                int scanOutstanding; // Callback priorities not yet complete
+
+                // Fit of the low range against the high range where both are good.
+                // A 'K' write puts the number of events in request, the readout
+                // thread takes it from there and sets gain and offset at the end.
+                struct calFit
+                        {
+                        int request;
+                        unsigned long remaining;
+                        unsigned long n;
+                        double sx, sy, sxx, sxy;
+                        }cal[Layout::NUM_CHAN];
+
+                // Every channel in every state of the cycle being read; the last
+                // state also takes any events after numStates until setState().
+                stateSample *pStateData;
+
+                int sampleState[Layout::NUM_CHAN]; // When state is this then store the data
                 int numStates; // Number of triggers per cycle
                 int currentState; // Which trigger are we on
-                static drvCaenV965Device *pDevice[NUM_BOARDS];     // We process all records on interrupt. All that did not process need
+                static drvCaenV965Board *pDevice[NUM_BOARDS];     // We process all records on interrupt. All that did not process need
+
+                // CBLT group, boards cbltFirst..cbltLast in adjacent slots.
+                // Only the last board interrupts; its thread reads the whole group.
+                static int cbltFirst; // -1 => no group
+                static int cbltLast;
+                static int cbltAddr; // A31..A24 of the CBLT address
+                static signed char geoMap[32]; // GEO in the data words => board, -1 none
+                static unsigned long *pGroupBlock;
         };
+
+// The names the two drivers have always used
+typedef drvCaenV965Board<caenV965Layout16> drvCaenV965Device;
+typedef drvCaenV965Board<caenV965Layout8> drvCaenV965_8Device;
+
+#endif
@@ -0,0 +1,1894 @@
+/*
+ * file:                drvV965Impl.h
+ * purpose:             Driver for CAEN V965 VME Charge Integrating Dual Range ADC
+ *                      Template implementation, included once per board layout
+ *                      by drvV965.cc of caenADCV965 and CaenADCV965_8
+ * created:             28-Oct-2005
+ *                      Oak Ridge National Laboratory
+ *
+ * revision history:
+ *   28-Oct-2005        David H Thompson        initial version
+ *   17-Aug-2006        Doug Murray             updated
+ */
+
+// This is a driver for the caen v965 VME board.
+// DH Thompson 10/28/2005
+// DHT@ORNL.GOV
+
+
+#ifndef DRVV965IMPL_H
+#define DRVV965IMPL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <epicsExport.h>
+#include <epicsThread.h>
+#include <epicsExit.h>
+#include <epicsInterrupt.h>
+#include <epicsAtomic.h>
+#include <epicsTime.h>
+#include <drvSup.h>
+#include <devLib.h>
+#include <link.h>
+
+#ifdef HAS_EPICSDMA
+extern "C"
+        {
+#include <epicsDma.h>
+        }
+#ifdef __rtems__
+#include <bsp/VME.h>
+#endif
+#endif
+
+#include "drvV965.h"
+#include "drvV965p.h"
+
+#ifndef VME_AM_EXT_SUP_ASCENDING
+#define VME_AM_EXT_SUP_ASCENDING 0x0f // A32 supervisor block transfer
+#endif
+#ifndef VME_AM_STD_SUP_ASCENDING
+#define VME_AM_STD_SUP_ASCENDING 0x3f // A24 supervisor block transfer
+#endif
+
+/* Not necessary in rtems 4.9 */
+/* extern "C" void printk( char *fmt, ...); */
+
+
+// ================== drvCaenV965Board Methods ============================
+// Constructor = Let every member have a known value initially
+template <class Layout>
+drvCaenV965Board<Layout>::
+drvCaenV965Board()
+        {
+        // Make sure that every member has a value
+        pBoard = NULL;
+        base = 0;
+        addrSpace = 0;
+        event = 0;
+        for( int i = 0 ; i < Layout::NUM_CHAN; i++)
+                for( int j = 0; j < 2; j++) // ADC_HI to ADC_LO
+                        {
+                        chanData[i][j].event = 0;
+                        chanData[i][j].data = 0;
+                        chanData[i][j].status = 0;
+                        chanData[i][j].threshold = 0;
+                        chanData[i][j].gain = CAEN_GAIN_DEFAULT;
+                        chanData[i][j].offset = 0;
+                        }
+        int_vector = 0;
+        int_level = 0;
+        ioscanpvt = NULL;
+        numStates = 0;
+        currentState = 0;
+
+        //
+        // The osi library does not have one of these... (semBCreate)
+        // We'll use epicsEventCreate here.
+        //
+        wakeupCall = epicsEventCreate( epicsEventEmpty);
+        readoutEvent = epicsEventCreate( epicsEventEmpty);
+        readoutThread = NULL;
+        pBlock = NULL;
+        dmaId = NULL;
+        pSim = NULL;
+        interruptCount = 0;
+        blockCount = 0;
+        wordCount = 0;
+        dmaErrors = 0;
+
+        pRing = NULL; // Allocated by init(), for configured boards only
+        ringHead = 0;
+        histClears = 0;
+        building.event = 0;
+        building.counter = 0;
+        building.state = 0;
+        for( int i = 0 ; i < Layout::NUM_CHAN; i++)
+                for( int j = 0; j < 2; j++)
+                        {
+                        building.data[i][j] = 0;
+                        building.status[i][j] = CAEN_STATUS_ABSENT;
+                        }
+        for( int i = 0 ; i < Layout::NUM_CHAN; i++)
+                {
+                building.value[i] = 0;
+                cal[i].request = 0;
+                cal[i].remaining = 0;
+                cal[i].n = 0;
+                cal[i].sx = cal[i].sy = cal[i].sxx = cal[i].sxy = 0;
+                }
+
+        for( int i = 0;i < 3;i++)
+                {
+                snapshots[i].seq = 0;
+                snapshots[i].event = 0;
+                for( int j = 0;j < Layout::NUM_CHAN;j++)
+                        for( int k = 0;k < 2;k++)
+                                {
+                                snapshots[i].chan[j][k].data = 0;
+                                snapshots[i].chan[j][k].status = 0;
+                                snapshots[i].chan[j][k].event = 0;
+                                snapshots[i].chan[j][k].value = 0;
+                                }
+                snapshots[i].pStates = NULL;
+                }
+        pStateData = NULL;
+        snapCurrent = 0;
+        snapPinned = -1;
+        scanBusy = 0;
+        scanOutstanding = 0;
+
+        for( int i = 0;i < Layout::NUM_CHAN;i++)
+                sampleState[i] = 0;
+        }
+
+// Epics device init routine.
+// Initialize all configured boards
+template <class Layout>
+long drvCaenV965Board<Layout>::
+init()
+        {
+        drvCaenV965Board * pvt;
+        epicsAtExit( drvCaenV965Board::atExit,NULL);
+        for( int i = 0;i < NUM_BOARDS;i++)
+                {
+                if(( pvt = pDevice[i]) == NULL)
+                        continue;
+
+                unsigned  vector = pvt->int_vector;
+                unsigned  level = pvt->int_level;
+                // The readout thread may request scans as soon as the interrupt is enabled
+                scanIoInit( &pvt->ioscanpvt);
+                scanIoSetComplete( pvt->ioscanpvt, drvCaenV965Board::scanComplete, pvt);
+
+                // numStates is fixed from here on
+                int nStates = pvt->stateCount() * Layout::NUM_CHAN;
+
+                pvt->pRing = new ringEvent[CAEN_RING_EVENTS];
+                pvt->pStateData = new stateSample[nStates];
+                for( int j = 0;j < 3;j++)
+                        pvt->snapshots[j].pStates = new stateSample[nStates];
+                for( int j = 0;j < nStates;j++)
+                        for( int k = 0;k < 2;k++)
+                                {
+                                pvt->pStateData[j].data[k] = 0;
+                                pvt->pStateData[j].status[k] = CAEN_STATUS_ABSENT;
+                                for( int l = 0;l < 3;l++)
+                                        {
+                                        pvt->snapshots[l].pStates[j].data[k] = 0;
+                                        pvt->snapshots[l].pStates[j].status[k] = CAEN_STATUS_ABSENT;
+                                        pvt->snapshots[l].pStates[j].value = 0;
+                                        }
+                                }
+                pvt->pBoard->bitSet1.set = Registers::BS1_SoftReset;
+                pvt->pBoard->bitSet1.clear = Registers::BS1_SoftReset;
+                if( level)
+                        {
+                        char name[20];
+
+                        sprintf( name, "V965_%d", i);
+                        pvt->pBlock = new unsigned long[CAEN_BLOCK_WORDS];
+#ifdef HAS_EPICSDMA
+                        pvt->dmaId = epicsDmaCreate( NULL, NULL);
+                        if( pvt->dmaId == NULL)
+                                printf( "drvCaenV965Board::init() No DMA for board %d, using single cycle reads\n", i);
+#endif
+                        pvt->readoutThread = epicsThreadCreate( name, epicsThreadPriorityHigh,
+                                                epicsThreadGetStackSize( epicsThreadStackMedium),
+                                                drvCaenV965Board::readoutTask, pvt);
+                        if( pvt->readoutThread == NULL)
+                                printf( "drvCaenV965Board::init() Can't start readout thread for board %d, interrupt not connected\n", i);
+                            else
+                                {
+                                devConnectInterruptVME( vector, (void (*)(void *)) &drvCaenV965Board::isr,(void *) pvt);
+                                pvt->pBoard->EventTriggerRegister = 1;
+                                pvt->pBoard->config( vector,level);
+                                devEnableInterruptLevel( intVME,level);
+                                }
+                        }
+                pvt->pBoard->show();
+                pvt->pBoard->CrateSelect = 0;
+                pvt->pBoard->EventTriggerRegister = 1;
+                pvt->pBoard->bitSet2.set = Registers::BS2_AllTrig  |
+                                        Registers::BS2_OverRangeEn |
+                                        Registers::BS2_LowThresholdEn |
+                                        Registers::BS2_EmptyEnable |
+                                        Registers::BS2_SlideEn;
+                pvt->pBoard->SlideConstant = 0;
+                pvt->pBoard->GeoAddress = 0;
+                }
+
+        if( cbltFirst >= 0 && setupGroup() != 0)
+                cbltFirst = cbltLast = -1;
+        return 0;
+        }
+
+// Epics report function. Give some info for DBIOR
+template <class Layout>
+long drvCaenV965Board<Layout>::
+report( int level)
+        {
+        for( int i = 0;i < NUM_BOARDS;i++)
+                if( pDevice[i])
+                        {
+                        printf( "Board: %d ",i);	
+                        if( pDevice[i]->pBoard)
+                                {
+                                pDevice[i]->pBoard->show();
+                                pDevice[i]->show( level);
+                                }
+                            else
+                                printf( "No board found\n");
+                        }
+        return 0;
+        }
+
+// Configure a device object once created.
+template <class Layout>
+int drvCaenV965Board<Layout>::
+caenV965Config( int board, size_t base, int addrSpace, int vector, int level, int states)
+        {
+        epicsAddressType addrType;
+        unsigned long probe;
+
+        if( board < 0 || board >= NUM_BOARDS)
+                {
+                printf( "caenV965Config() Sorry, we don't have storage for board: %d\n", board);
+                return -1;
+                }
+
+        if(  drvCaenV965Board::pDevice[board]!=NULL)
+                {
+                printf( "caenV965Config() Sorry, you have already initialized board: %d\n", board);
+                return -1;
+                }
+
+        if( addrSpace != 24 && addrSpace != 32)
+                {
+                printf( "caenV965Config() The ADC must be in A24 or A32 space;  using A%d is not recognized\n", addrSpace);
+                return -1;
+                }
+
+        if( vector >255 || vector < 0)
+                {
+                printf( "caenV965Config() Sorry, the vector for board: %d must be >0 and <256 \n", board);
+                return -1;
+                }
+
+        if( level > 7 || level < 0)
+                {
+                printf( "caenV965Config() Sorry, the vector for board: %d must be >0 and <256 \n", board);
+                return -1;
+                }
+
+        // looks good so far:
+
+        drvCaenV965Board *pvt = new drvCaenV965Board;
+
+        if( addrSpace == 24)
+                addrType = atVMEA24;
+            else
+                addrType = atVMEA32;
+
+        /*
+        if( devRegisterAddress( Layout::name(), atVMEA24, base, sizeof( Registers), (volatile void **)&pvt->pBoard) != 0)
+        */
+        if( devRegisterAddress( Layout::name(), addrType, base, sizeof( Registers), (volatile void **)&pvt->pBoard) != 0)
+                {
+                delete pvt;
+                return -1;
+                }
+        if( devReadProbe( sizeof( unsigned long),
+                          (volatile const void *)&pvt->pBoard,
+                          (void *) &probe) )
+                {
+                printf( "caenV965Config() The board %d at base address %x does not exist\n", board, base);
+                (void)devUnregisterAddress( addrType, base, Layout::name());
+                delete pvt;
+                return -1;
+                }
+
+        if( pvt->pBoard->getModelNumber() != Registers::CAEN_MODEL_NUMBER)
+                {
+                printf( "caenV965Config() The board at the given address is not the correct model (Expecting V%d, found V%d)\n", Registers::CAEN_MODEL_NUMBER, pvt->pBoard->getModelNumber());
+                (void)devUnregisterAddress( addrType, base, Layout::name());
+                delete pvt;
+                return -1;
+                }
+
+        pDevice[board] = pvt;
+        pvt->base = base;
+        pvt->addrSpace = addrSpace;
+        pvt->int_level = level;
+        pvt->int_vector = vector;
+
+        for( int i = 0; i < Layout::NUM_CHAN;i++)
+                pvt->pBoard->enableChannel( i, false);
+
+        pvt->numStates = states;
+        pvt->currentState = 0;
+
+        return 0;
+        }
+
+// Put boards first..last into a CBLT group. Call after caenV965Config() for
+// all of them and before iocInit. The boards must sit in adjacent slots with
+// first leftmost; only last should have an interrupt level.
+template <class Layout>
+int drvCaenV965Board<Layout>::
+cbltConfig( int first, int last, int addr)
+        {
+
+        if( first < 0 || last >= NUM_BOARDS || first >= last)
+                {
+                printf( "%sCbltConfig() Need at least two boards, first < last < %d\n", Layout::name(), NUM_BOARDS);
+                return -1;
+                }
+        if( addr <= 0 || addr > 255)
+                {
+                printf( "%sCbltConfig() The CBLT address is A31..A24 and must be 1 to 255\n", Layout::name());
+                return -1;
+                }
+        for( int i = first;i <= last;i++)
+                if( pDevice[i] == NULL)
+                        {
+                        printf( "%sCbltConfig() Board %d is not configured\n", Layout::name(), i);
+                        return -1;
+                        }
+        if( pDevice[last]->int_level == 0)
+                {
+                printf( "%sCbltConfig() The last board (%d) needs an interrupt level\n", Layout::name(), last);
+                return -1;
+                }
+        for( int i = first;i < last;i++)
+                if( pDevice[i]->int_level)
+                        printf( "%sCbltConfig() Board %d will not use its interrupt, the group interrupts on board %d\n", Layout::name(), i, last);
+
+        cbltFirst = first;
+        cbltLast = last;
+        cbltAddr = addr;
+        return 0;
+        }
+
+// Program the CBLT group; called from init() once every board has been reset.
+template <class Layout>
+int drvCaenV965Board<Layout>::
+setupGroup()
+        {
+        int i;
+
+        // The chained transfer only ends with a bus error, which a single
+        // cycle read of an empty board would get as well
+        if( pDevice[cbltLast]->dmaId == NULL)
+                {
+                printf( "drvCaenV965Board::setupGroup() Board %d has no DMA, no CBLT\n", cbltLast);
+                return -1;
+                }
+
+        for( i = 0;i < 32;i++)
+                geoMap[i] = -1;
+
+        for( i = cbltFirst;i <= cbltLast;i++)
+                {
+                Registers *pRegs = pDevice[i]->pBoard;
+                int geo;
+
+                // readoutGroup() falls back to drain() on every board of the group,
+                // but init() gave a buffer only to boards with an interrupt level
+                if( pDevice[i]->pBlock == NULL)
+                        pDevice[i]->pBlock = new unsigned long[CAEN_BLOCK_WORDS];
+
+                // VME64x crates set GEO from the slot and ignore this write
+                pRegs->GeoAddress = i;
+                geo = pRegs->GeoAddress & 0x1f;
+                if( geoMap[geo] >= 0)
+                        {
+                        printf( "drvCaenV965Board::setupGroup() Boards %d and %d both have GEO %d, no CBLT\n", geoMap[geo], i, geo);
+                        for( i = cbltFirst;i <= cbltLast;i++)
+                                pDevice[i]->pBoard->MCST_CBLTCtrl = Registers::MCST_Disabled;
+                        return -1;
+                        }
+                geoMap[geo] = i;
+
+                pRegs->MSCT_CBLT_Address = cbltAddr;
+                pRegs->ControlRegister1 = pRegs->ControlRegister1 | Registers::CR1_BerrEnable;
+                if( i == cbltFirst)
+                        pRegs->MCST_CBLTCtrl = Registers::MCST_FirstBoard;
+                    else if( i == cbltLast)
+                        pRegs->MCST_CBLTCtrl = Registers::MCST_LastBoard;
+                    else
+                        pRegs->MCST_CBLTCtrl = Registers::MCST_MiddleBoard;
+                // Only the last board interrupts
+                if( i != cbltLast)
+                        pRegs->EventTriggerRegister = 0;
+                }
+
+        pGroupBlock = new unsigned long[CAEN_BLOCK_WORDS * ( cbltLast - cbltFirst + 1)];
+        printf( "drvCaenV965Board::setupGroup() Boards %d to %d read by CBLT at 0x%02x000000\n", cbltFirst, cbltLast, cbltAddr);
+        return 0;
+        }
+
+// This is the interrupt service routine for one board.
+// Only take the interrupt away from the board and hand the readout to the thread;
+// the interrupt is released because the event trigger level is now zero.
+template <class Layout>
+void drvCaenV965Board<Layout>::
+isr( void *pdev)
+        {
+        drvCaenV965Board * pThis=(drvCaenV965Board * )pdev;
+
+        pThis->pBoard->EventTriggerRegister = 0;
+        pThis->interruptCount++;
+        epicsEventSignal( pThis->readoutEvent);
+        }
+
+// One of these runs per board with an interrupt level.
+// Drain the output buffer in blocks, then re-arm the interrupt.
+template <class Layout>
+void drvCaenV965Board<Layout>::
+readoutTask( void *pdev)
+        {
+        drvCaenV965Board * pThis=(drvCaenV965Board * )pdev;
+
+        for( ;;)
+                {
+                epicsEventMustWait( pThis->readoutEvent);
+
+                if( cbltFirst >= 0 && pThis == pDevice[cbltLast])
+                        pThis->readoutGroup();
+                    else
+                        pThis->drain();
+
+                // Anything left over will interrupt again right away
+                pThis->pBoard->EventTriggerRegister = 1;
+                }
+        }
+
+// Read this board's output buffer until it is empty or we have done CAEN_MAX_BLOCKS
+template <class Layout>
+void drvCaenV965Board<Layout>::
+drain()
+        {
+        int nWords;
+
+        for( int i = 0;i < CAEN_MAX_BLOCKS;i++)
+                {
+                if( pBoard->StatusRegister2 & Registers::ST2_BufferEmpty)
+                        break;
+                nWords = readBlock( pBlock, CAEN_BLOCK_WORDS);
+                if( nWords <= 0)
+                        break;
+                blockCount++;
+                wordCount += nWords;
+                if( decode( pBlock, nWords) < nWords)
+                        break; // Hit the end of the data
+                }
+        }
+
+// Read every board of the CBLT group; called on the last board.
+// The chained transfer ends with a bus error from the last board, so
+// the buffer is filled with filler words first and decoding stops at the
+// first one left. Without DMA each board is read on its own.
+template <class Layout>
+void drvCaenV965Board<Layout>::
+readoutGroup()
+        {
+        int board;
+
+        for( int pass = 0;pass < CAEN_MAX_BLOCKS;pass++)
+                {
+                for( board = cbltFirst;board <= cbltLast;board++)
+                        if( !( pDevice[board]->pBoard->StatusRegister2 & Registers::ST2_BufferEmpty))
+                                break;
+                if( board > cbltLast)
+                        break; // All empty
+
+#ifdef HAS_EPICSDMA
+                if( dmaId)
+                        {
+                        int nWords = CAEN_BLOCK_WORDS * ( cbltLast - cbltFirst + 1);
+
+                        for( int i = 0;i < nWords;i++)
+                                pGroupBlock[i] = Registers::OBT_not_valid_datum;
+                        // A bus error is the normal end of the transfer
+                        (void) epicsDmaFromVmeAndWait( dmaId, pGroupBlock, (epicsUInt32) cbltAddr << 24, VME_AM_EXT_SUP_ASCENDING,
+                                                nWords * sizeof( epicsUInt32), sizeof( epicsUInt32));
+                        if(( pGroupBlock[0] & Registers::OBT_mask) != Registers::OBT_not_valid_datum)
+                                {
+                                blockCount++;
+                                wordCount += dispatch( pGroupBlock, nWords);
+                                continue;
+                                }
+                        // Nothing came back although a board has data
+                        dmaErrors++;
+                        }
+#endif
+                for( board = cbltFirst;board <= cbltLast;board++)
+                        pDevice[board]->drain();
+                }
+        }
+
+// Hand each run of words from the same board to that board's decoder.
+// Returns the number of words used.
+template <class Layout>
+int drvCaenV965Board<Layout>::
+dispatch( const unsigned long *pBuf, int nWords)
+        {
+        int start = 0;
+        int board = -1;
+        int i;
+
+        for( i = 0;i < nWords;i++)
+                {
+                int geo;
+
+                if(( pBuf[i] & Registers::OBT_mask) == Registers::OBT_not_valid_datum)
+                        break;
+                geo = ( pBuf[i] & Registers::OBB_GEO) / Registers::OBB_GEO_SHIFT;
+                if( geoMap[geo] != board)
+                        {
+                        if( board >= 0)
+                                pDevice[board]->decode( pBuf + start, i - start);
+                        board = geoMap[geo];
+                        start = i;
+                        }
+                }
+        if( board >= 0)
+                pDevice[board]->decode( pBuf + start, i - start);
+        return i;
+        }
+
+// Copy up to maxWords of the output buffer into pBuf.
+// Returns the number of words transferred; the data ends at the first filler word.
+template <class Layout>
+int drvCaenV965Board<Layout>::
+readBlock( unsigned long *pBuf, int maxWords)
+        {
+        int i;
+
+        if( pSim)
+                return simRead( pBuf, maxWords);
+
+#ifdef HAS_EPICSDMA
+        if( dmaId)
+                {
+                int am = ( addrSpace == 24) ? VME_AM_STD_SUP_ASCENDING : VME_AM_EXT_SUP_ASCENDING;
+
+                for( i = 0;i < maxWords;i++)
+                        pBuf[i] = Registers::OBT_not_valid_datum;
+                // A board of the CBLT group ends the transfer with a bus error;
+                // whatever was moved before it is still good
+                if( epicsDmaFromVmeAndWait( dmaId, pBuf, (epicsUInt32) base, am, maxWords * sizeof( epicsUInt32), sizeof( epicsUInt32)) == 0 ||
+                    ( pBuf[0] & Registers::OBT_mask) != Registers::OBT_not_valid_datum)
+                        return maxWords;
+                // Nothing moved; read this block single cycle
+                dmaErrors++;
+                }
+#endif
+
+        // Single cycle reads stop at the first filler word. Check for an empty
+        // buffer after each event, as a board in the CBLT group answers a read
+        // of an empty buffer with a bus error.
+        for( i = 0;i < maxWords;i++)
+                {
+                pBuf[i] = pBoard->OutputBuffer[0];
+                if(( pBuf[i] & Registers::OBT_mask) == Registers::OBT_not_valid_datum)
+                        return i + 1;
+                if(( pBuf[i] & Registers::OBT_mask) == Registers::OBT_end_block &&
+                    ( pBoard->StatusRegister2 & Registers::ST2_BufferEmpty))
+                        return i + 1;
+                }
+        return i;
+        }
+
+// Decode a block of output buffer words.
+// Returns the number of words used; less than nWords if a filler word ended the data.
+template <class Layout>
+int drvCaenV965Board<Layout>::
+decode( const unsigned long *pBuf, int nWords)
+        {
+        unsigned long buffer;
+        typename Registers::OutputBufferWordType type;
+        int chan;
+        int range;
+        int i;
+
+        for( i = 0;i < nWords;i++)
+                {
+                buffer = pBuf[i];
+
+                type = (typename Registers::OutputBufferWordType)( buffer&Registers::OBT_mask);
+
+                switch( type)
+                        {
+
+                case Registers::OBT_header:
+                        for( chan = 0;chan < Layout::NUM_CHAN;chan++)
+                                building.status[chan][ADC_HI] = building.status[chan][ADC_LO] = CAEN_STATUS_ABSENT;
+                        break;
+
+                case Registers::OBT_valid_datum:
+                        chan=(buffer & Registers::OBB_CHANNEL)/Registers::OBB_CHANNEL_SHIFT;
+                        //chan=(buffer>>18)&15;
+                        range=(buffer & Registers::OBB_RG)?ADC_LO:ADC_HI;
+                        building.data[chan][range] = buffer & Registers::OBB_ADC;
+                        building.status[chan][range] = ( buffer & Registers::OBB_UN) ? 1 : ( buffer & Registers::OBB_OV) ? 2 : 0;
+                        if( pStateData)
+                                {
+                                stateSample *pState = &pStateData[(( currentState < stateCount()) ? currentState : stateCount() - 1) * Layout::NUM_CHAN + chan];
+
+                                pState->data[range] = building.data[chan][range];
+                                pState->status[range] = building.status[chan][range];
+                                }
+                        if( sampleState[chan] && currentState == 0)
+                                // request to set the threshold;
+                                chanData[chan][range].threshold=(buffer & Registers::OBB_ADC);
+                            else
+                                if( sampleState[chan] == 0 || currentState == sampleState[chan])
+                                        {
+                                        chanData[chan][range].data=(buffer & Registers::OBB_ADC);
+                                        chanData[chan][range].event = event+1;
+
+                                        if( buffer & Registers::OBB_UN)
+                                        chanData[chan][range].status = 1;
+                                        else if( buffer & Registers::OBB_OV)
+                                        chanData[chan][range].status = 2;
+                                        else
+                                        chanData[chan][range].status = 0;
+                                        }
+                        break;
+
+                case Registers::OBT_end_block:
+                        // Publish to the ring before the records get to scan
+                        building.event = event+1;
+                        building.counter = buffer & Registers::OBB_EVENT_COUNTER;
+                        building.state = currentState;
+                        for( chan = 0;chan < Layout::NUM_CHAN;chan++)
+                                building.value[chan] = splice( chan, building.data[chan][ADC_HI], building.status[chan][ADC_HI],
+                                                building.data[chan][ADC_LO], building.status[chan][ADC_LO]);
+                        calibrate();
+                        pRing[ringHead % CAEN_RING_EVENTS] = building;
+                        epicsAtomicWriteMemoryBarrier();
+                        epicsAtomicSetSizeT( &ringHead, ringHead + 1);
+
+                        // Handle scaniorequest here
+                        currentState++;
+                        if( currentState >= numStates)
+                                {
+                                // We must reset for this to work
+                                event++;
+                                currentState = numStates;
+                                publish();
+                                startScan();
+
+                                epicsEventSignal( wakeupCall);
+                                }
+                        break;
+
+                case Registers::OBT_not_valid_datum:
+                default:
+                        // The board pads a block transfer with these once it is empty
+                        return i;
+                        }
+                }
+        return i;
+        }
+
+// This gets called when the IOC reboots.
+// Try to disable the interrupt.
+template <class Layout>
+void drvCaenV965Board<Layout>::
+atExit(void *)
+        {
+
+        for( int i = 0;i < NUM_BOARDS;i++)
+                if( pDevice[i] && pDevice[i]->pBoard)
+                        pDevice[i]->pBoard->EventTriggerRegister = 0; // 4.19 = Turns interrupts off
+
+        }
+
+//
+// This is a debug routine - Just show what is in the output buffer
+//
+template <class Layout>
+int drvCaenV965Board<Layout>::
+readOutputBuffer()
+        {
+
+        for( int i = 0;i < Layout::NUM_CHAN;i++)
+                printf("Chan %d: h=%d/%d l=%d/%d ss=%d\n",
+                        i,
+                        chanData[i][ADC_HI].data,
+                        chanData[i][ADC_HI].status,
+                        chanData[i][ADC_LO].data,
+                        chanData[i][ADC_LO].status,
+                        sampleState[i]);
+        return 0;
+        }
+
+//
+// Print the contents of the Board's ID register
+//
+template <class Layout>
+void drvCaenV965RegisterMap<Layout>::
+show()
+        {
+        int out;
+
+        printf( "CAEN V965 ADC:\n");
+
+        out = (( ROM[BoardIdMSB] & 0xFF) << 16) | (( ROM[BoardId] & 0xFF) << 8) | ( ROM[BoardIdLSB] & 0xFF);
+        printf( "%20s: V%d\n", "Model", out);
+
+        printf( "%20s: %d\n", "Version", ROM[Version] & 0xFF);
+
+        out = (( ROM[SerialMSB] & 0xFF) << 8) | ( ROM[SerialLSB] & 0xFF);
+        printf( "%20s: %d\n", "Serial Number", out);
+
+        out = (( ROM[OUI_MSB] & 0xFF) << 16) | (( ROM[OUI] & 0xFF) << 8) | ( ROM[OUI_LSB] & 0xFF);
+        printf( "%20s: %d [%#08x]\n", "Manufacturer ID", out, out);
+
+        printf( "Registers:: Frmw = 0x%04x OUI = 0x%x ROM OUI = 0x%02x%02x%02x version = 0x%02x Board = 0x%02x%02x%02x Serial = 0x%02x%02x\n",
+                (unsigned)FirmwareRevision,
+                0xff & OUI,
+                0xff & ROM[OUI_MSB],
+                0xff & ROM[OUI],
+                0xff & ROM[OUI_LSB],
+                0xff & ROM[Version],
+                0xff & ROM[BoardIdMSB],
+                0xff & ROM[BoardId],
+                0xff & ROM[BoardIdLSB],
+                0xff & ROM[SerialMSB],
+                0xff & ROM[SerialLSB]);
+        printf("                       level=%d, vec = 0x%02x, iped=%d\n",
+                0x07 & InterruptLevel ,
+                0xff & InterruptVector,
+                0xff & Iped);
+        }
+
+/* ============================================================================ *\
+** ================= drvCaenV965RegisterMap Methods ============================ **
+*  These sparce methods operate directly on the hardware                        **
+\* ============================================================================ */
+
+template <class Layout>
+int drvCaenV965RegisterMap<Layout>::
+config( int vector, int level)
+        {
+
+        if( vector < 0 || vector > 255 || level < 1 || level > 7 )
+                return -1;
+
+        InterruptVector = vector;
+        InterruptLevel = level;
+        printf("Registers::config(int %d,int %d)\n",vector,level);
+        return 0;
+        }
+
+template <class Layout>
+void drvCaenV965Board<Layout>::
+show( int level)
+        {
+
+        printf("Status 1:%s%s%s%s%s%s\n",
+                pBoard->StatusRegister1 & Registers::ST1_Dready       ? " DREADY" : "",
+                pBoard->StatusRegister1 & Registers::ST1_GlobalDready ? " Global DREADY" : "",
+                pBoard->StatusRegister1 & Registers::ST1_Busy         ? " Busy" : "",
+                pBoard->StatusRegister1 & Registers::ST1_GlobalBusy   ? " Global Busy" : "",
+                pBoard->StatusRegister1 & Registers::ST1_EvRdy        ? " EvRDY" : "",
+                pBoard->StatusRegister1 & Registers::ST1_Purged       ? " Purged" : "");
+        printf("Interrupts: %lu blocks: %lu words: %lu readout: %s dma errors: %lu\n",
+                interruptCount, blockCount, wordCount, dmaId ? "BLT32" : "single cycle", dmaErrors);
+        printf("Events in ring: %lu\n", (unsigned long) ringHead);
+        if( cbltFirst >= 0 && this == pDevice[cbltLast])
+                printf("CBLT group: boards %d to %d at 0x%02x000000\n", cbltFirst, cbltLast, cbltAddr);
+        if( level > 1)
+                readOutputBuffer();
+        }
+
+template <class Layout>
+int drvCaenV965Board<Layout>::
+recordInit( DBLINK *pLink, dbCommon *pRec)
+        {
+        int card;
+        int rv = 0;
+        int signal;
+        const char *pparm = "";
+        drvCaenV965Board *pDev = NULL;
+
+        if( VME_IO != pLink->type)
+                return -1;
+
+        card = pLink->value.vmeio.card;
+
+        if( card < 0 || card >= NUM_BOARDS || NULL == ( pDev = pDevice[card]))
+                return -1;
+
+        signal = pLink->value.vmeio.signal;
+
+        if( signal < 0 || Layout::NUM_CHAN <= signal)
+                return -1;
+
+        if( pLink->value.vmeio.parm)
+                pparm = pLink->value.vmeio.parm;
+
+        switch( *pparm)
+                {
+        case 'I': // IPED 
+                break;
+
+        case 'N': // Serial number
+                break;
+
+        case 'H': // high ADC
+                pDev->pBoard->enableHiChannel( signal, true);
+                break;
+
+        case 'L': // Low ADC
+                pDev->pBoard->enableLoChannel( signal, true);
+                break;
+
+        case 'G': // gain value
+        case 'O': // High range offset
+        case 'K': // Calibrate
+        case 'S': // Channel status
+        case 'T': // Threshold
+        case 'Z': // Threshold on the board
+        case 'U': // Zero suppression
+        case 'V': // Overflow suppression
+        case 'E': // Event number
+        case 'C': // Clear histograms
+                break;
+
+        case 'B': // Channels signal.. of the board as one array
+                for( int i = signal;i < Layout::NUM_CHAN;i++)
+                        if( pparm[1] == 'H')
+                                pDev->pBoard->enableHiChannel( i, true);
+                            else if( pparm[1] == 'L')
+                                pDev->pBoard->enableLoChannel( i, true);
+                            else
+                                pDev->pBoard->enableChannel( i, true);
+                break;
+
+        case 'W': // History from the event ring
+        case 'Y': // Histogram from the event ring
+        case 'P': // Every state of the cycle
+                if( pparm[1] == 'H')
+                        pDev->pBoard->enableHiChannel( signal, true);
+                    else if( pparm[1] == 'L')
+                        pDev->pBoard->enableLoChannel( signal, true);
+                    else if( pparm[1] != 'E')
+                        pDev->pBoard->enableChannel( signal, true);
+                break;
+
+        case 0:
+                pDev->pBoard->enableChannel( signal, true);
+                break;
+
+        case '1' ... '9':
+                pDev->sampleState[signal] = atoi( pparm);
+                pDev->pBoard->enableChannel( signal, true);
+                break;
+
+        default:
+                printf("drvCaenV965: Invalid option: %c on card %d signal %d\n", *pparm?*pparm:' ',card,signal);
+                return -1;
+                break;
+                }
+
+        return rv;
+        }
+
+// ================== drvCaenV965DPVT Methods ============================
+template <class Layout>
+int drvCaenV965Board<Layout>::
+getValue(DBLINK * pLink, epicsInt32 * value) // Returns status
+        {
+
+        if( VME_IO != pLink->type)
+                return -1;
+        int card = pLink->value.vmeio.card;
+        int signal = pLink->value.vmeio.signal;
+        drvCaenV965Board * pDev = NULL;
+        if( card < 0 || card >= NUM_BOARDS || NULL == ( pDev= pDevice[card]))
+                return -1;
+
+        return pDev->getValue(signal, pLink->value.vmeio.parm, value) ;
+        }
+
+template <class Layout>
+int drvCaenV965Board<Layout>::
+getValue( int signal, const char * pparm , epicsInt32 * value) // Returns status
+        {
+        int parm = 0;
+        int sparm = 0;
+        int rv = 0;
+        chanSample sample[2];
+        unsigned long latest;
+
+        if( signal < 0 || Layout::NUM_CHAN <= signal)
+                return -1;
+
+	// Grab the field type:
+	if( pparm) parm = pparm[0];
+	if( parm) sparm = pparm[1];
+	
+
+	readChannel( signal, sample, &latest);
+
+	switch( parm)
+                {
+
+	case 'I': // IPED 
+		*value = pBoard->getIped();
+		break;
+
+	case 'N':
+		*value = pBoard->getSerialNumber();
+		break;
+
+	case 'H':
+		*value = sample[ADC_HI].data;
+		if( sample[ADC_HI].status&2)
+                        rv=-1;
+		// Check to see if the data was the latest 
+		if( latest != sample[ADC_HI].event)
+			rv=-1;
+		break;
+	
+	case 'L':
+		*value = sample[ADC_LO].data;
+		if( sample[ADC_LO].status&2)
+                        rv=-1;
+		// Check to see if the data was the latest 
+		if( latest != sample[ADC_LO].event)
+			rv=-1;
+		break;
+
+	case 'S':
+		*value = ((sample[ADC_HI].status&3)<<2) | (sample[ADC_LO].status&3) ;
+		break;
+
+	case 'T':
+		*value = chanData[signal][(sparm=='H')?ADC_HI:ADC_LO].threshold;
+		break;
+
+	case 'Z':
+		*value = pBoard->getThreshold(( sparm == 'H') ? Registers::hiThreshold( signal) : Registers::loThreshold( signal));
+		break;
+
+	case 'U':
+		*value = !( pBoard->bitSet2.set & Registers::BS2_LowThresholdEn);
+		break;
+
+	case 'V':
+		*value = !( pBoard->bitSet2.set & Registers::BS2_OverRangeEn);
+		break;
+
+	case 'G':
+		*value = chanData[signal][ADC_HI].gain;
+		break;
+
+	case 'O':
+		*value = chanData[signal][ADC_HI].offset;
+		break;
+
+	case 'K':
+		*value = epicsAtomicGetIntT( &cal[signal].request) + cal[signal].remaining;
+		break;
+
+        case 'E':
+		*value = latest;
+		break;
+
+	default:
+	case 0:
+		*value = sample[ADC_LO].value;
+		if( sample[ADC_LO].status&2 || (sample[ADC_LO].data > CAEN_SPLICE_LIMIT))
+                        {
+                        if( sample[ADC_HI].status&2)
+                                rv=-1;
+                        // Check to see if the data was the latest
+                        if( latest != sample[ADC_LO].event)
+                                rv=-1;
+                        }
+		    else
+                        {
+                        // Check to see if the data was the latest
+                        if( latest != sample[ADC_LO].event)
+                                rv=-1;
+                        }
+		break;
+                }
+	return rv;
+        }
+
+// Copy chanData into a snapshot that no record scan is using and make it current.
+// Only the readout thread calls this.
+template <class Layout>
+void drvCaenV965Board<Layout>::
+publish()
+        {
+        int current = epicsAtomicGetIntT( &snapCurrent);
+        int pinned = epicsAtomicGetIntT( &snapPinned);
+        int w;
+
+        // A scan can only pin the current one, so this stays free
+        for( w = 0;w == current || w == pinned;w++)
+                ;
+        snapshot *pSnap = &snapshots[w];
+
+        epicsAtomicSetSizeT( &pSnap->seq, pSnap->seq + 1);
+        epicsAtomicWriteMemoryBarrier();
+        pSnap->event = event;
+        for( int i = 0;i < Layout::NUM_CHAN;i++)
+                for( int j = 0;j < 2;j++)
+                        {
+                        pSnap->chan[i][j].data = chanData[i][j].data;
+                        pSnap->chan[i][j].status = chanData[i][j].status;
+                        pSnap->chan[i][j].event = chanData[i][j].event;
+                        }
+        for( int i = 0;i < Layout::NUM_CHAN;i++)
+                pSnap->chan[i][ADC_HI].value = pSnap->chan[i][ADC_LO].value = splice( i, chanData[i][ADC_HI].data, chanData[i][ADC_HI].status,
+                                chanData[i][ADC_LO].data, chanData[i][ADC_LO].status);
+        if( pStateData)
+                for( int i = 0;i < stateCount() * Layout::NUM_CHAN;i++)
+                        {
+                        stateSample *pState = &pStateData[i];
+
+                        pState->value = splice( i % Layout::NUM_CHAN, pState->data[ADC_HI], pState->status[ADC_HI],
+                                        pState->data[ADC_LO], pState->status[ADC_LO]);
+                        pSnap->pStates[i] = *pState;
+                        // The next cycle starts out empty
+                        pState->status[ADC_HI] = pState->status[ADC_LO] = CAEN_STATUS_ABSENT;
+                        }
+        epicsAtomicWriteMemoryBarrier();
+        epicsAtomicSetSizeT( &pSnap->seq, pSnap->seq + 1);
+        epicsAtomicSetIntT( &snapCurrent, w);
+        }
+
+// Start an I/O Intr scan on the current snapshot unless one is running;
+// scanComplete() starts another if something was published meanwhile.
+template <class Layout>
+void drvCaenV965Board<Layout>::
+startScan()
+        {
+        unsigned int queued;
+        int n = 0;
+
+        if( epicsAtomicCmpAndSwapIntT( &scanBusy, 0, 1) != 0)
+                return;
+        epicsAtomicSetIntT( &snapPinned, epicsAtomicGetIntT( &snapCurrent));
+        queued = scanIoRequest( ioscanpvt);
+        for( ;queued;queued >>= 1)
+                n += queued & 1;
+        if( epicsAtomicAddIntT( &scanOutstanding, n) == 0)
+                scanComplete( this, ioscanpvt, -1);
+        }
+
+// scanIoSetComplete() callback, once per callback priority
+template <class Layout>
+void drvCaenV965Board<Layout>::
+scanComplete( void *pdev, IOSCANPVT, int prio)
+        {
+        drvCaenV965Board * pThis=(drvCaenV965Board * )pdev;
+        int scanned;
+
+        if( prio >= 0 && epicsAtomicDecrIntT( &pThis->scanOutstanding) != 0)
+                return;
+        scanned = epicsAtomicGetIntT( &pThis->snapPinned);
+        epicsAtomicSetIntT( &pThis->snapPinned, -1);
+        epicsAtomicSetIntT( &pThis->scanBusy, 0);
+        if( epicsAtomicGetIntT( &pThis->snapCurrent) != scanned)
+                pThis->startScan();
+        }
+
+// Get one channel, both ranges, and the cycle count from the same snapshot
+template <class Layout>
+void drvCaenV965Board<Layout>::
+readChannel( int signal, chanSample *pSample, unsigned long *pEvent)
+        {
+
+        readChannels( signal, 1, ( chanSample ( *)[2])pSample, pEvent);
+        }
+
+// The same for channels first..first+count-1
+template <class Layout>
+void drvCaenV965Board<Layout>::
+readChannels( int first, int count, chanSample ( *pSample)[2], unsigned long *pEvent)
+        {
+        const snapshot *pSnap;
+        size_t seq;
+        int idx;
+
+        do
+                {
+                idx = epicsAtomicGetIntT( &snapPinned);
+                if( idx < 0)
+                        idx = epicsAtomicGetIntT( &snapCurrent);
+                pSnap = &snapshots[idx];
+                seq = epicsAtomicGetSizeT( &pSnap->seq);
+                epicsAtomicReadMemoryBarrier();
+                for( int i = 0;i < count;i++)
+                        {
+                        pSample[i][ADC_HI] = pSnap->chan[first + i][ADC_HI];
+                        pSample[i][ADC_LO] = pSnap->chan[first + i][ADC_LO];
+                        }
+                *pEvent = pSnap->event;
+                epicsAtomicReadMemoryBarrier();
+                }while(( seq & 1) || seq != epicsAtomicGetSizeT( &pSnap->seq));
+        }
+
+// Combine the two ranges of one channel into a 15 bit value.
+// The readout thread does this once per event; records only copy the result.
+template <class Layout>
+long drvCaenV965Board<Layout>::
+splice( int signal, int hi, int hiStatus, int lo, int loStatus)
+        {
+
+        if( loStatus&2 || lo > CAEN_SPLICE_LIMIT)
+                return ((( hi - chanData[signal][ADC_HI].threshold) * chanData[signal][ADC_HI].gain) >> 12) + chanData[signal][ADC_HI].offset;
+        return lo - chanData[signal][ADC_LO].threshold;
+        }
+
+//
+// Accumulate the event in building for every channel being calibrated.
+// Only events where both ranges are in range and the low range is in the
+// top part of its scale are used. When enough are in, fit
+// lo = gain * hi + offset (threshold subtracted) and use that from then on.
+//
+template <class Layout>
+void drvCaenV965Board<Layout>::
+calibrate()
+        {
+
+        for( int chan = 0;chan < Layout::NUM_CHAN;chan++)
+                {
+                calFit *pCal = &cal[chan];
+                int request = epicsAtomicGetIntT( &pCal->request);
+
+                if( request > 0)
+                        {
+                        epicsAtomicSetIntT( &pCal->request, 0);
+                        pCal->remaining = request;
+                        pCal->n = 0;
+                        pCal->sx = pCal->sy = pCal->sxx = pCal->sxy = 0;
+                        }
+                if( pCal->remaining == 0 || building.status[chan][ADC_HI] != 0 || building.status[chan][ADC_LO] != 0)
+                        continue;
+                if( building.data[chan][ADC_LO] < CAEN_CAL_LO_MIN || building.data[chan][ADC_LO] > CAEN_SPLICE_LIMIT)
+                        continue;
+
+                double x = building.data[chan][ADC_HI] - chanData[chan][ADC_HI].threshold;
+                double y = building.data[chan][ADC_LO] - chanData[chan][ADC_LO].threshold;
+
+                pCal->n++;
+                pCal->sx += x;
+                pCal->sy += y;
+                pCal->sxx += x * x;
+                pCal->sxy += x * y;
+                if( --pCal->remaining)
+                        continue;
+
+                double det = pCal->n * pCal->sxx - pCal->sx * pCal->sx;
+
+                if( det <= 0)
+                        {
+                        printf( "drvCaenV965Board::calibrate() channel %d: high range does not vary, gain unchanged\n", chan);
+                        continue;
+                        }
+                double slope = ( pCal->n * pCal->sxy - pCal->sx * pCal->sy) / det;
+                double intercept = ( pCal->sy - slope * pCal->sx) / pCal->n;
+
+                chanData[chan][ADC_HI].gain = (long)( slope * 4096 + 0.5);
+                chanData[chan][ADC_HI].offset = (long)( intercept + (( intercept < 0) ? -0.5 : 0.5));
+                printf( "drvCaenV965Board::calibrate() channel %d: gain %ld/4096 offset %ld from %lu events\n",
+                                chan, chanData[chan][ADC_HI].gain, chanData[chan][ADC_HI].offset, pCal->n);
+                }
+        }
+
+template <class Layout>
+int drvCaenV965Board<Layout>::
+getHistory( DBLINK * pLink, drvCaenV965Cursor *pCursor, epicsInt32 *pBuf, int nelm)
+        {
+
+        if( VME_IO != pLink->type)
+                return -1;
+        int card = pLink->value.vmeio.card;
+        int signal = pLink->value.vmeio.signal;
+        drvCaenV965Board * pDev = NULL;
+        if( card < 0 || card >= NUM_BOARDS || NULL == ( pDev= pDevice[card]))
+                return -1;
+
+        return pDev->getHistory( signal, pLink->value.vmeio.parm, pCursor, pBuf, nelm);
+        }
+
+//
+// Fill a waveform from the event ring.
+// 'W' the spliced value, 'WH'/'WL' one range, 'WE' the board event counter;
+// oldest first, the most recent nelm events. Returns the number of elements.
+// 'Y', 'YH', 'YL' add the events not yet seen by this record to a histogram
+// of nelm bins over the full scale. Returns nelm.
+// The ring is read without a lock: the readout thread may reuse an entry while
+// we copy it, so anything older than CAEN_RING_EVENTS-1 behind the head at the
+// end of the copy is dropped.
+//
+template <class Layout>
+int drvCaenV965Board<Layout>::
+getHistory( int signal, const char *pparm, drvCaenV965Cursor *pCursor, epicsInt32 *pBuf, int nelm)
+        {
+        int parm = 0;
+        int sparm = 0;
+        size_t head;
+        size_t first;
+        size_t after;
+        size_t clears;
+        size_t i;
+        int n;
+        long value;
+
+        if( signal < 0 || Layout::NUM_CHAN <= signal || nelm <= 0 || pRing == NULL)
+                return -1;
+
+        if( pparm) parm = pparm[0];
+        if( parm) sparm = pparm[1];
+
+        head = epicsAtomicGetSizeT( &ringHead);
+        epicsAtomicReadMemoryBarrier();
+        first = ( head > CAEN_RING_EVENTS - 1) ? head - ( CAEN_RING_EVENTS - 1) : 0;
+
+        switch( parm)
+                {
+        case 'W':
+                if( head - first > (size_t) nelm)
+                        first = head - nelm;
+                for( i = first, n = 0;i < head;i++, n++)
+                        {
+                        ringEvent *pEvent = &pRing[i % CAEN_RING_EVENTS];
+
+                        if( sparm == 'H')
+                                pBuf[n] = pEvent->data[signal][ADC_HI];
+                            else if( sparm == 'L')
+                                pBuf[n] = pEvent->data[signal][ADC_LO];
+                            else if( sparm == 'E')
+                                pBuf[n] = pEvent->counter;
+                            else
+                                pBuf[n] = pEvent->value[signal];
+                        }
+                epicsAtomicReadMemoryBarrier();
+                after = epicsAtomicGetSizeT( &ringHead);
+                if( after > first + ( CAEN_RING_EVENTS - 1))
+                        {
+                        // Lost the oldest ones while copying
+                        size_t lost = after - ( CAEN_RING_EVENTS - 1) - first;
+
+                        if( lost >= (size_t) n)
+                                return 0;
+                        for( i = 0;i < n - lost;i++)
+                                pBuf[i] = pBuf[i + lost];
+                        n -= lost;
+                        }
+                if( pCursor)
+                        pCursor->next = head;
+                return n;
+
+        case 'Y':
+                if( pCursor == NULL)
+                        return -1;
+                clears = epicsAtomicGetSizeT( &histClears);
+                if( pCursor->clears != clears)
+                        {
+                        for( n = 0;n < nelm;n++)
+                                pBuf[n] = 0;
+                        pCursor->clears = clears;
+                        pCursor->next = head;
+                        }
+                if( pCursor->next > first)
+                        first = pCursor->next;
+                for( i = first;i < head;i++)
+                        {
+                        ringEvent *pEvent = &pRing[i % CAEN_RING_EVENTS];
+
+                        if( sparm == 'H' || sparm == 'L')
+                                {
+                                int range = ( sparm == 'H') ? ADC_HI : ADC_LO;
+
+                                if( pEvent->status[signal][range] & CAEN_STATUS_ABSENT)
+                                        continue;
+                                n = ( pEvent->data[signal][range] * nelm) >> 12;
+                                }
+                            else
+                                {
+                                if( pEvent->status[signal][ADC_LO] & CAEN_STATUS_ABSENT)
+                                        continue;
+                                value = pEvent->value[signal];
+                                if( value < 0)
+                                        value = 0;
+                                if( value > 0x7fff)
+                                        value = 0x7fff;
+                                n = ( value * nelm) >> 15;
+                                }
+                        pBuf[n]++;
+                        }
+                pCursor->next = head;
+                return nelm;
+
+        default:
+                return -1;
+                }
+        }
+
+template <class Layout>
+int drvCaenV965Board<Layout>::
+getBoard( DBLINK * pLink, epicsInt32 *pBuf, int nelm, bool *pStale)
+        {
+
+        if( VME_IO != pLink->type)
+                return -1;
+        int card = pLink->value.vmeio.card;
+        int signal = pLink->value.vmeio.signal;
+        drvCaenV965Board * pDev = NULL;
+        if( card < 0 || card >= NUM_BOARDS || NULL == ( pDev= pDevice[card]))
+                return -1;
+
+        return pDev->getBoard( signal, pLink->value.vmeio.parm, pBuf, nelm, pStale);
+        }
+
+//
+// Fill an array with channels signal, signal+1, .. of the latest cycle,
+// all from one snapshot.
+// 'B' the spliced value, 'BH'/'BL' one range, 'BS' the status as 'S'.
+// *pStale is set if any of them was not read in that cycle.
+// Returns the number of elements.
+//
+template <class Layout>
+int drvCaenV965Board<Layout>::
+getBoard( int signal, const char *pparm, epicsInt32 *pBuf, int nelm, bool *pStale)
+        {
+        int sparm = 0;
+        chanSample sample[Layout::NUM_CHAN][2];
+        unsigned long latest;
+        int n;
+
+        if( signal < 0 || Layout::NUM_CHAN <= signal || nelm <= 0)
+                return -1;
+
+        if( pparm && pparm[0])
+                sparm = pparm[1];
+
+        n = Layout::NUM_CHAN - signal;
+        if( n > nelm)
+                n = nelm;
+        readChannels( signal, n, sample, &latest);
+
+        *pStale = false;
+        for( int i = 0;i < n;i++)
+                {
+                int range = ( sparm == 'H') ? ADC_HI : ADC_LO;
+
+                switch( sparm)
+                        {
+                case 'H':
+                case 'L':
+                        pBuf[i] = sample[i][range].data;
+                        break;
+
+                case 'S':
+                        pBuf[i] = (( sample[i][ADC_HI].status&3)<<2) | ( sample[i][ADC_LO].status&3);
+                        break;
+
+                default:
+                        pBuf[i] = sample[i][ADC_LO].value;
+                        break;
+                        }
+                if( latest != sample[i][range].event)
+                        *pStale = true;
+                }
+        return n;
+        }
+
+template <class Layout>
+int drvCaenV965Board<Layout>::
+getPattern( DBLINK * pLink, epicsInt32 *pBuf, int nelm)
+        {
+
+        if( VME_IO != pLink->type)
+                return -1;
+        int card = pLink->value.vmeio.card;
+        int signal = pLink->value.vmeio.signal;
+        drvCaenV965Board * pDev = NULL;
+        if( card < 0 || card >= NUM_BOARDS || NULL == ( pDev= pDevice[card]))
+                return -1;
+
+        return pDev->getPattern( signal, pLink->value.vmeio.parm, pBuf, nelm);
+        }
+
+//
+// Fill an array with one channel in each state of the latest cycle.
+// 'P' the spliced value, 'PH'/'PL' one range, 'PS' the status as 'S',
+// plus 16 for a state the channel was not read in (the value is then 0).
+// Returns the number of elements, at most the number of states.
+//
+template <class Layout>
+int drvCaenV965Board<Layout>::
+getPattern( int signal, const char *pparm, epicsInt32 *pBuf, int nelm)
+        {
+        int sparm = 0;
+        const snapshot *pSnap;
+        size_t seq;
+        int idx;
+        int n;
+
+        if( signal < 0 || Layout::NUM_CHAN <= signal || nelm <= 0 || pStateData == NULL)
+                return -1;
+
+        if( pparm && pparm[0])
+                sparm = pparm[1];
+
+        n = ( stateCount() < nelm) ? stateCount() : nelm;
+        do
+                {
+                idx = epicsAtomicGetIntT( &snapPinned);
+                if( idx < 0)
+                        idx = epicsAtomicGetIntT( &snapCurrent);
+                pSnap = &snapshots[idx];
+                seq = epicsAtomicGetSizeT( &pSnap->seq);
+                epicsAtomicReadMemoryBarrier();
+                for( int i = 0;i < n;i++)
+                        {
+                        const stateSample *pState = &pSnap->pStates[i * Layout::NUM_CHAN + signal];
+                        int range = ( sparm == 'H') ? ADC_HI : ADC_LO;
+                        bool absent = pState->status[range] & CAEN_STATUS_ABSENT;
+
+                        switch( sparm)
+                                {
+                        case 'H':
+                        case 'L':
+                                pBuf[i] = absent ? 0 : pState->data[range];
+                                break;
+
+                        case 'S':
+                                pBuf[i] = (( pState->status[ADC_HI]&3)<<2) | ( pState->status[ADC_LO]&3) | ( absent ? 16 : 0);
+                                break;
+
+                        default:
+                                pBuf[i] = absent ? 0 : pState->value;
+                                break;
+                                }
+                        }
+                epicsAtomicReadMemoryBarrier();
+                }while(( seq & 1) || seq != epicsAtomicGetSizeT( &pSnap->seq));
+        return n;
+        }
+
+template <class Layout>
+int drvCaenV965Board<Layout>::
+putValue(DBLINK * pLink, epicsInt32  value) // Return status
+        {
+
+        if( VME_IO != pLink->type)
+                return -1;
+        int card = pLink->value.vmeio.card;
+        int signal = pLink->value.vmeio.signal;
+        drvCaenV965Board * pDev = NULL;
+
+        if( card < 0 || card >= NUM_BOARDS || NULL == ( pDev= pDevice[card]))
+                return -1;
+
+        return pDev->putValue(signal,pLink->value.vmeio.parm,value);
+        }
+
+template <class Layout>
+int drvCaenV965Board<Layout>::
+putValue( int signal , const char * pparm, epicsInt32  value) // Return status
+        {
+
+        int rv = 0;
+        int parm = 0;
+        int sparm = 0;
+
+        if( signal < 0 || Layout::NUM_CHAN <= signal) 
+                return -1;
+
+        if( pparm)
+                parm = pparm[0];
+        if( parm)
+                sparm = pparm[1];
+
+        switch( parm)
+                {
+        case 'I': // IPED 
+                pBoard->setIped( value);
+                break;
+
+        case 'G':
+                chanData[signal][ADC_HI].gain = value ? value : CAEN_GAIN_DEFAULT;
+                break;
+
+        case 'O':
+                chanData[signal][ADC_HI].offset = value;
+                break;
+
+        case 'K': // Calibrate the gain and offset over this many events
+                if( value <= 0)
+                        rv = -1;
+                    else
+                        epicsAtomicSetIntT( &cal[signal].request, value);
+                break;
+
+        case 'T':
+                chanData[signal][( sparm=='H')?ADC_HI:ADC_LO].threshold = value;
+                break;
+
+        case 'C': // Clear the histograms of every channel
+                epicsAtomicIncrSizeT( &histClears);
+                break;
+
+        case 'Z': // Board threshold in ADC counts
+                if( sparm == 'H')
+                        pBoard->setThreshold( Registers::hiThreshold( signal), value);
+                    else if( sparm == 'L')
+                        pBoard->setThreshold( Registers::loThreshold( signal), value);
+                    else if( sparm == 'T')
+                        // Every channel: value counts above its software threshold
+                        for( int i = 0;i < Layout::NUM_CHAN;i++)
+                                {
+                                pBoard->setThreshold( Registers::hiThreshold( i), chanData[i][ADC_HI].threshold + value);
+                                pBoard->setThreshold( Registers::loThreshold( i), chanData[i][ADC_LO].threshold + value);
+                                }
+                    else
+                        {
+                        pBoard->setThreshold( Registers::hiThreshold( signal), value);
+                        pBoard->setThreshold( Registers::loThreshold( signal), value);
+                        }
+                break;
+
+        case 'U': // Drop channels under their threshold
+                suppress( Registers::BS2_LowThresholdEn, value != 0);
+                break;
+
+        case 'V': // Drop over range channels
+                suppress( Registers::BS2_OverRangeEn, value != 0);
+                break;
+
+        default:
+        case 0:
+                rv=-1;
+                break;
+                }
+        return rv;
+        }
+
+template <class Layout>
+long drvCaenV965Board<Layout>::
+getIOIntInfo( int cmd, DBLINK * pLink, IOSCANPVT * ppvt)
+        {
+        int rv = 0;
+
+        if( VME_IO != pLink->type)
+                return -1;
+        int card = pLink->value.vmeio.card;
+        drvCaenV965Board * pDev = NULL;
+
+        if( card < 0 || card >= NUM_BOARDS || NULL == ( pDev= pDevice[card]))
+                return -1;
+        int signal = pLink->value.vmeio.signal;
+        if( signal < 0 || Layout::NUM_CHAN <= signal)
+                return -1;
+
+
+        *ppvt = pDev->ioscanpvt;
+
+        return rv;
+        }
+
+template <class Layout>
+void drvCaenV965Board<Layout>::
+setState( int newState)
+        {
+
+        if( currentState > 1 && currentState < numStates)
+                printf( "drvCaenV965Board::setState() currentState < numStates %d %d\n",currentState, numStates);
+        currentState = newState;
+        }
+
+template <class Layout>
+drvCaenV965Board<Layout> *drvCaenV965Board<Layout>::
+getV965Handle( int card)
+        {
+	if( card < 0 || card >= NUM_BOARDS )
+		return NULL;
+        return drvCaenV965Board::pDevice[card];
+        }
+
+// ======================= Simulated boards ==============================
+//
+// A simulated board has its registers in memory and a software FIFO standing
+// in for the output buffer. It goes through the same drain/decode/publish
+// path as a real one, so records and the ring work as usual; there is just
+// no interrupt. Use it to time the readout on the target or on a host IOC.
+//
+template <class Layout>
+int drvCaenV965Board<Layout>::
+simConfig( int board, int states)
+        {
+
+        if( board < 0 || board >= NUM_BOARDS)
+                {
+                printf( "%sSimConfig() Sorry, we don't have storage for board: %d\n", Layout::name(), board);
+                return -1;
+                }
+        if( pDevice[board] != NULL)
+                {
+                printf( "%sSimConfig() Sorry, you have already initialized board: %d\n", Layout::name(), board);
+                return -1;
+                }
+
+        drvCaenV965Board *pvt = new drvCaenV965Board;
+
+        pvt->pBoard = (Registers *) calloc( 1, sizeof( Registers));
+        if( pvt->pBoard == NULL)
+                {
+                delete pvt;
+                return -1;
+                }
+        pvt->pBoard->ROM[Registers::BoardId] = Registers::CAEN_MODEL_NUMBER >> 8;
+        pvt->pBoard->ROM[Registers::BoardIdLSB] = Registers::CAEN_MODEL_NUMBER & 0xff;
+        pvt->pBoard->StatusRegister2 = Registers::ST2_BufferEmpty;
+
+        pvt->pSim = new simFifo;
+        pvt->pSim->pWords = new unsigned long[CAEN_SIM_WORDS];
+        pvt->pSim->head = 0;
+        pvt->pSim->tail = 0;
+        pvt->pSim->counter = 0;
+        pvt->pSim->seed = board + 1;
+        pvt->pBlock = new unsigned long[CAEN_BLOCK_WORDS];
+
+        pDevice[board] = pvt;
+        pvt->addrSpace = 32;
+        for( int i = 0; i < Layout::NUM_CHAN;i++)
+                pvt->pBoard->enableChannel( i, false);
+        pvt->numStates = states;
+        pvt->currentState = 0;
+        return 0;
+        }
+
+// Generate events events with random charges on every channel and read them out
+template <class Layout>
+int drvCaenV965Board<Layout>::
+simBench( int board, int events)
+        {
+        drvCaenV965Board *pDev = getSimHandle( board);
+        size_t before;
+        unsigned long words;
+        double seconds = 0;
+
+        if( pDev == NULL)
+                return -1;
+
+        before = pDev->ringHead;
+        words = pDev->wordCount;
+        for( int n = 0;n < events;)
+                {
+                while( n < events && pDev->pSim->tail - pDev->pSim->head <= CAEN_SIM_WORDS - ( 2 * Layout::NUM_CHAN + 2))
+                        {
+                        pDev->simEvent();
+                        n++;
+                        }
+                seconds += pDev->simRun();
+                }
+        pDev->simResult( "synthetic", pDev->ringHead - before, pDev->wordCount - words, seconds);
+        return 0;
+        }
+
+// Read output buffer words, one hex number each, from a file and read them out
+template <class Layout>
+int drvCaenV965Board<Layout>::
+simReplay( int board, const char *file)
+        {
+        drvCaenV965Board *pDev = getSimHandle( board);
+        size_t before;
+        unsigned long words;
+        unsigned long word;
+        double seconds = 0;
+        FILE *fp;
+
+        if( pDev == NULL)
+                return -1;
+        if( file == NULL || ( fp = fopen( file, "r")) == NULL)
+                {
+                printf( "%sSimReplay() Can't open %s\n", Layout::name(), file ? file : "(null)");
+                return -1;
+                }
+
+        before = pDev->ringHead;
+        words = pDev->wordCount;
+        while( fscanf( fp, "%lx", &word) == 1)
+                if( !pDev->simPush( word))
+                        {
+                        seconds += pDev->simRun();
+                        pDev->simPush( word);
+                        }
+        fclose( fp);
+        seconds += pDev->simRun();
+        pDev->simResult( file, pDev->ringHead - before, pDev->wordCount - words, seconds);
+        return 0;
+        }
+
+template <class Layout>
+drvCaenV965Board<Layout> *drvCaenV965Board<Layout>::
+getSimHandle( int board)
+        {
+        drvCaenV965Board *pDev = getV965Handle( board);
+
+        if( pDev == NULL || pDev->pSim == NULL)
+                {
+                printf( "%s: board %d is not a simulated board\n", Layout::name(), board);
+                return NULL;
+                }
+        if( pDev->ioscanpvt == NULL)
+                {
+                printf( "%s: board %d, run this after iocInit\n", Layout::name(), board);
+                return NULL;
+                }
+        return pDev;
+        }
+
+// The simulated output buffer: the board returns filler words once it is empty
+template <class Layout>
+int drvCaenV965Board<Layout>::
+simRead( unsigned long *pBuf, int maxWords)
+        {
+        int i;
+
+        for( i = 0;i < maxWords;i++)
+                {
+                if( pSim->head == pSim->tail)
+                        {
+                        pBoard->StatusRegister2 = Registers::ST2_BufferEmpty;
+                        pBuf[i] = Registers::OBT_not_valid_datum;
+                        return i + 1;
+                        }
+                pBuf[i] = pSim->pWords[pSim->head++ % CAEN_SIM_WORDS];
+                }
+        if( pSim->head == pSim->tail)
+                pBoard->StatusRegister2 = Registers::ST2_BufferEmpty;
+        return i;
+        }
+
+template <class Layout>
+bool drvCaenV965Board<Layout>::
+simPush( unsigned long word)
+        {
+
+        if( pSim->tail - pSim->head >= CAEN_SIM_WORDS)
+                return false;
+        pSim->pWords[pSim->tail++ % CAEN_SIM_WORDS] = word;
+        pBoard->StatusRegister2 = 0;
+        return true;
+        }
+
+// One event as the board would write it: every channel that is not killed
+// in both ranges, less what the threshold and overflow suppression drop
+template <class Layout>
+void drvCaenV965Board<Layout>::
+simEvent()
+        {
+        unsigned long words[2 * Layout::NUM_CHAN];
+        bool zeroSuppress = !( pBoard->bitSet2.set & Registers::BS2_LowThresholdEn);
+        bool overSuppress = !( pBoard->bitSet2.set & Registers::BS2_OverRangeEn);
+        int n = 0;
+
+        for( unsigned long chan = 0;chan < Layout::NUM_CHAN;chan++)
+                {
+                unsigned long charge;
+                unsigned long adc[2];
+                int index[2];
+
+                pSim->seed = pSim->seed * 1103515245 + 12345;
+                charge = ( pSim->seed >> 16) & 0x7fff;
+                adc[ADC_HI] = charge >> 3;
+                adc[ADC_LO] = ( charge > 0xfff) ? Registers::OBB_OV | 0xfff : charge;
+                index[ADC_HI] = Registers::hiThreshold( chan);
+                index[ADC_LO] = Registers::loThreshold( chan);
+                for( int range = ADC_HI;range <= ADC_LO;range++)
+                        {
+                        if( pBoard->Thresholds[index[range]] & 0x100)
+                                continue;
+                        if( zeroSuppress && (int)( adc[range] & Registers::OBB_ADC) < pBoard->getThreshold( index[range]))
+                                continue;
+                        if( overSuppress && ( adc[range] & Registers::OBB_OV))
+                                continue;
+                        words[n++] = chan * Registers::OBB_CHANNEL_SHIFT | (( range == ADC_LO) ? Registers::OBB_RG : 0) | adc[range];
+                        }
+                }
+        simPush( Registers::OBT_header | n << Registers::OBB_CNT_SHIFT);
+        for( int i = 0;i < n;i++)
+                simPush( words[i]);
+        simPush( Registers::OBT_end_block | ( pSim->counter & Registers::OBB_EVENT_COUNTER));
+        pSim->counter++;
+        pBoard->EventCounterL = pSim->counter & 0xffff;
+        pBoard->EventCounterH = ( pSim->counter >> 16) & 0xff;
+        }
+
+// Memory has no bit set/clear registers, so a simulated board gets the result written
+template <class Layout>
+void drvCaenV965Board<Layout>::
+suppress( int bits, bool enable)
+        {
+
+        if( pSim == NULL)
+                pBoard->suppress( bits, enable);
+            else if( enable)
+                pBoard->bitSet2.set = pBoard->bitSet2.set & ~bits;
+            else
+                pBoard->bitSet2.set = pBoard->bitSet2.set | bits;
+        }
+
+// Empty the FIFO the way readoutTask does after each interrupt; returns the time taken
+template <class Layout>
+double drvCaenV965Board<Layout>::
+simRun()
+        {
+        epicsTimeStamp start;
+        epicsTimeStamp end;
+
+        epicsTimeGetCurrent( &start);
+        while( pSim->head != pSim->tail)
+                {
+                interruptCount++;
+                drain();
+                }
+        epicsTimeGetCurrent( &end);
+        return epicsTimeDiffInSeconds( &end, &start);
+        }
+
+template <class Layout>
+void drvCaenV965Board<Layout>::
+simResult( const char *what, size_t events, unsigned long words, double seconds)
+        {
+
+        printf( "%s %s: %lu events, %lu words in %.3f s", Layout::name(), what, (unsigned long) events, words, seconds);
+        if( events && seconds > 0)
+                printf( ", %.0f events/s, %.2f us/event", events / seconds, seconds * 1e6 / events);
+        printf( "\n");
+        }
+
+// This is the static storage for boards;
+
+template <class Layout>
+drvCaenV965Board<Layout> * drvCaenV965Board<Layout>::pDevice[NUM_BOARDS];
+
+template <class Layout>
+int drvCaenV965Board<Layout>::cbltFirst = -1;
+template <class Layout>
+int drvCaenV965Board<Layout>::cbltLast = -1;
+template <class Layout>
+int drvCaenV965Board<Layout>::cbltAddr = 0;
+template <class Layout>
+signed char drvCaenV965Board<Layout>::geoMap[32];
+template <class Layout>
+unsigned long *drvCaenV965Board<Layout>::pGroupBlock = NULL;
+
+#endif
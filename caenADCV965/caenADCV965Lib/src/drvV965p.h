@@ -2,11 +2,20 @@
 // DH Thompson 10/28/2005
 // DHT@ORNL.GOV
 
-// This is a driver for the caen v965 VME board.
-// DH Thompson 10/28/2005
-// DHT@ORNL.GOV
+#ifndef DRVV965P_H
+#define DRVV965P_H
+
 #include "dbScan.h"
+#ifdef __rtems__
 #include <libcpu/io.h>
+#else
+// Only simulated boards on a host, see drvCaenV965Board::simConfig()
+#include <epicsMMIO.h>
+#define in_be16( addr) be_ioread16( addr)
+#define out_be16( addr, val) be_iowrite16( addr, val)
+#define in_be32( addr) be_ioread32( addr)
+#define out_be32( addr, val) be_iowrite32( addr, val)
+#endif
 
 #include "epicsMutex.h"
 
@@ -20,15 +29,14 @@
  *   28-Oct-2005        David H Thompson        initial version
  *   17-Aug-2006        Doug Murray             updated
  */
-class drvCaenV965Device;
-
-class drvCaenV965Registers
+template <class Layout>
+class drvCaenV965RegisterMap
         {
         // We will allow this class to access the registers directly where it makes sense.
-        friend class drvCaenV965Device;
+        friend class drvCaenV965Board<Layout>;
 
         public:
-                static const int CAEN_NUM_SIGNALS = 16;
+                static const int CAEN_NUM_SIGNALS = Layout::NUM_CHAN;
                 static const int CAEN_MODEL_NUMBER = 965;
 
                 void show();
@@ -40,12 +48,20 @@ class drvCaenV965Registers
                 inline void enableChannel( int chan, bool enable);
                 inline void enableLoChannel( int chan, bool enable);
                 inline void enableHiChannel( int chan, bool enable);
+                inline int thresholdStep();
+                inline void setThreshold( int index, int counts);
+                inline int getThreshold( int index);
+                inline void suppress( int bits, bool enable);
 
         private:
-                drvCaenV965Registers()
+                drvCaenV965RegisterMap()
                         {
                         }; // No public constructor
 
+                // Threshold memory index of a channel's high and low range
+                static int hiThreshold( int chan) { return chan * 2 * Layout::THRESHOLD_STRIDE; }
+                static int loThreshold( int chan) { return chan * 2 * Layout::THRESHOLD_STRIDE + Layout::THRESHOLD_STRIDE; }
+
                 class CaenD16
                         {
                         public:
@@ -72,12 +88,6 @@ class drvCaenV965Registers
                         CaenD16 clear;
                         };
 
-                struct ThresholdPair
-                        {
-                        CaenD16 high;
-                        CaenD16 low;
-                        };
-
                 //
                 // Data:
                 // Registers: Reference page 33 of the manual
@@ -125,7 +135,7 @@ class drvCaenV965Registers
                 CaenD16 AAD;                            // 0x1070
                 CaenD16 BAD;                            // 0x1072
                 unsigned char unused8[12];              // 0x1074
-                ThresholdPair Thresholds[16];           // 0x1080-0x10bf
+                CaenD16 Thresholds[32];                 // 0x1080-0x10bf, see hiThreshold()
                 char unused9[0x8000 - 0x10c0];          // 0x10c0-0x8000
                 CaenD16 ROM[0x4000];
 
@@ -165,9 +175,9 @@ class drvCaenV965Registers
                         OBB_CNT = 0x3f<<8,
 
                         // Datum bits
-                        OBB_CHANNEL_SHIFT = 1<<17,
-                        OBB_CHANNEL = 0xf<<17,
-                        OBB_RG = 1<<16, // 4.5 is wrong?
+                        OBB_CHANNEL_SHIFT = 1<<Layout::CHANNEL_SHIFT,
+                        OBB_CHANNEL = ( Layout::NUM_CHAN - 1)<<Layout::CHANNEL_SHIFT,
+                        OBB_RG = Layout::RANGE_BIT, // 4.5 is wrong?
                         OBB_UN = 1<<13,
                         OBB_OV = 1<<12,
                         OBB_ADC = 0xfff<<0,
@@ -175,6 +185,22 @@ class drvCaenV965Registers
                         OBB_EVENT_COUNTER = 0xffffff<<0
                         };
 
+                enum ControlRegister1Bits
+                        {
+                        CR1_BlkEnd = 1<<2,
+                        CR1_ProgReset = 1<<4,
+                        CR1_BerrEnable = 1<<5,
+                        CR1_Align64 = 1<<6
+                        };
+
+                enum McstCbltCtrlValues
+                        {
+                        MCST_Disabled = 0,
+                        MCST_LastBoard = 1,
+                        MCST_FirstBoard = 2,
+                        MCST_MiddleBoard = 3
+                        };
+
                 enum BitSet1Bits
                         {
                         BS1_BerrFlag = 1<<3,
@@ -194,7 +220,7 @@ class drvCaenV965Registers
                         BS2_TestAc1 = 1<<6,
                         BS2_SlideEn = 1<<7,
 
-                        // Reserved - 8
+                        BS2_StepThreshold = 1<<8, // Threshold memory counts 2 ADC counts, not 16
                         // not used - 9
                         // not used - 10
                         BS2_AutoIncr = 1<<11,
@@ -223,14 +249,16 @@ class drvCaenV965Registers
                         };
         };
 
-inline drvCaenV965Registers::CaenD16::
+template <class Layout>
+inline drvCaenV965RegisterMap<Layout>::CaenD16::
 operator unsigned short()
         {
 
         return in_be16( &loc);
         }
 
-inline unsigned short drvCaenV965Registers::CaenD16::
+template <class Layout>
+inline unsigned short drvCaenV965RegisterMap<Layout>::CaenD16::
 operator =( const unsigned short data)
         {
 
@@ -238,14 +266,16 @@ operator =( const unsigned short data)
         return data;
         }
 
-inline drvCaenV965Registers::CaenD32::
+template <class Layout>
+inline drvCaenV965RegisterMap<Layout>::CaenD32::
 operator unsigned long()
         {
 
         return in_be32((volatile unsigned int *)&loc);
         }
 
-inline unsigned long drvCaenV965Registers::CaenD32::
+template <class Layout>
+inline unsigned long drvCaenV965RegisterMap<Layout>::CaenD32::
 operator =( const unsigned long data)
         {
 
@@ -253,57 +283,104 @@ operator =( const unsigned long data)
         return data;
         }
 
-inline unsigned short drvCaenV965Registers::
+template <class Layout>
+inline unsigned short drvCaenV965RegisterMap<Layout>::
 getIped()
         {
 
         return Iped;
         }
 
-inline void drvCaenV965Registers::
+template <class Layout>
+inline void drvCaenV965RegisterMap<Layout>::
 setIped(unsigned short val)
         {
 
         Iped = val;
         }
 
-inline void drvCaenV965Registers::
+template <class Layout>
+inline void drvCaenV965RegisterMap<Layout>::
 enableChannel(int chan, bool enable)
         {
-        unsigned short threshold;
 
-        threshold = 0xff & Thresholds[chan].high;
-        Thresholds[chan].high = threshold | (enable ? 0 : 0x100);
-        threshold = 0xff & Thresholds[chan].low;
-        Thresholds[chan].low = threshold | (enable ? 0 : 0x100);
+        enableHiChannel( chan, enable);
+        enableLoChannel( chan, enable);
         }
 
-inline void drvCaenV965Registers::
+template <class Layout>
+inline void drvCaenV965RegisterMap<Layout>::
 enableLoChannel(int chan, bool enable)
         {
         unsigned short threshold;
 
-        threshold = 0xff & Thresholds[chan].low;
-        Thresholds[chan].low = threshold | (enable ? 0 : 0x100);
+        threshold = 0xff & Thresholds[loThreshold( chan)];
+        Thresholds[loThreshold( chan)] = threshold | (enable ? 0 : 0x100);
         }
 
-inline void drvCaenV965Registers::
+template <class Layout>
+inline void drvCaenV965RegisterMap<Layout>::
 enableHiChannel(int chan, bool enable)
         {
         unsigned short threshold;
 
-        threshold = 0xff & Thresholds[chan].high;
-        Thresholds[chan].high = threshold | (enable ? 0 : 0x100);
+        threshold = 0xff & Thresholds[hiThreshold( chan)];
+        Thresholds[hiThreshold( chan)] = threshold | (enable ? 0 : 0x100);
         }
 
-inline int drvCaenV965Registers::
+// ADC counts per unit of threshold memory
+template <class Layout>
+inline int drvCaenV965RegisterMap<Layout>::
+thresholdStep()
+        {
+
+        return ( bitSet2.set & BS2_StepThreshold) ? 2 : 16;
+        }
+
+// Set a threshold memory entry in ADC counts, keeping the kill bit
+template <class Layout>
+inline void drvCaenV965RegisterMap<Layout>::
+setThreshold( int index, int counts)
+        {
+        int value = ( counts + thresholdStep() - 1) / thresholdStep();
+
+        if( value < 0)
+                value = 0;
+        if( value > 0xff)
+                value = 0xff;
+        Thresholds[index] = ( 0x100 & Thresholds[index]) | value;
+        }
+
+template <class Layout>
+inline int drvCaenV965RegisterMap<Layout>::
+getThreshold( int index)
+        {
+
+        return ( 0xff & Thresholds[index]) * thresholdStep();
+        }
+
+// The BS2 bits disable the suppression when set
+template <class Layout>
+inline void drvCaenV965RegisterMap<Layout>::
+suppress( int bits, bool enable)
+        {
+
+        if( enable)
+                bitSet2.clear = bits;
+            else
+                bitSet2.set = bits;
+        }
+
+template <class Layout>
+inline int drvCaenV965RegisterMap<Layout>::
 getModelNumber()
         {
         
         return((( ROM[BoardIdMSB] & 0xFF) << 16) | (( ROM[BoardId] & 0xFF) << 8) | ( ROM[BoardIdLSB] & 0xFF));
         }
 
-inline long drvCaenV965Registers::
+template <class Layout>
+inline long drvCaenV965RegisterMap<Layout>::
 getSerialNumber()
         {
         long rv = 0;
@@ -312,3 +389,5 @@ getSerialNumber()
         rv = ( rv << 8) | (ROM[SerialLSB] & 0xff);
         return rv;
         }
+
+#endif
@@ -46,6 +46,9 @@
 #include	"recSup.h"
 #include	"devSup.h"
 #include	"aiRecord.h"
+#include	"waveformRecord.h"
+#include	"dbFldTypes.h"
+#include	"link.h"
 #include	"drvSpearTimestamp.h"
 #include	"epicsExport.h"
 
@@ -71,13 +74,223 @@ struct {
 	NULL
 };
 epicsExportAddress(dset, devSpearTimestamp);
+
+/* Processed on a TSSM interrupt; INP "@SYNC" or "@EVENT<n>" (n=0..6).
+ * VAL is the timestamp as of that interrupt.
+ */
+static long init_record_src();
+static long get_ioint_info_src();
+static long read_ai_src();
+
+struct {
+	long		number;
+	DEVSUPFUN	report;
+	DEVSUPFUN	init;
+	DEVSUPFUN	init_record;
+	DEVSUPFUN	get_ioint_info;
+	DEVSUPFUN	read_ai;
+	DEVSUPFUN	special_linconv;
+}devSpearTimestampSource={
+	6,
+	NULL,
+	NULL,
+	init_record_src,
+	get_ioint_info_src,
+	read_ai_src,
+	NULL
+};
+epicsExportAddress(dset, devSpearTimestampSource);
 
 
+/* Latency monitor (see spearTimestampLatencyReport)
+ *   ai:       INP "@LATENCY <stat>" or "@JITTER <stat>",
+ *             stat is MEAN, RMS, MIN, MAX, COUNT or MISSED
+ *   waveform: INP "@LATENCY" or "@JITTER"; FTVL LONG or ULONG
+ */
+static long init_record_lat();
+static long read_ai_lat();
+static long init_record_hist();
+static long read_wf_hist();
+
+struct {
+	long		number;
+	DEVSUPFUN	report;
+	DEVSUPFUN	init;
+	DEVSUPFUN	init_record;
+	DEVSUPFUN	get_ioint_info;
+	DEVSUPFUN	read_ai;
+	DEVSUPFUN	special_linconv;
+}devSpearTimestampLatency={
+	6,
+	NULL,
+	NULL,
+	init_record_lat,
+	0,
+	read_ai_lat,
+	NULL
+};
+epicsExportAddress(dset, devSpearTimestampLatency);
+
+struct {
+	long		number;
+	DEVSUPFUN	report;
+	DEVSUPFUN	init;
+	DEVSUPFUN	init_record;
+	DEVSUPFUN	get_ioint_info;
+	DEVSUPFUN	read_wf;
+}devSpearTimestampHistogram={
+	5,
+	NULL,
+	NULL,
+	init_record_hist,
+	0,
+	read_wf_hist
+};
+epicsExportAddress(dset, devSpearTimestampHistogram);
+
+#define LAT_MEAN	0
+#define LAT_RMS		1
+#define LAT_MIN		2
+#define LAT_MAX		3
+#define LAT_COUNT	4
+#define LAT_MISSED	5
+
+/* which histogram; *pp is left after the name */
+static int parse_hist(DBLINK *plink, char **pp)
+{
+char *s;
+	if ( INST_IO != plink->type || !(s = plink->value.instio.string) )
+		return -1;
+	while ( ' ' == *s )
+		s++;
+	if ( !strncmp(s, "LATENCY", 7) ) {
+		*pp = s + 7;
+		return SPEAR_TIMESTAMP_HIST_LATENCY;
+	}
+	if ( !strncmp(s, "JITTER", 6) ) {
+		*pp = s + 6;
+		return SPEAR_TIMESTAMP_HIST_JITTER;
+	}
+	return -1;
+}
+
+static long init_record_lat(aiRecord *pai)
+{
+static const char *stats[] = { "MEAN", "RMS", "MIN", "MAX", "COUNT", "MISSED", 0 };
+char *s;
+int   which, st;
+	if ( (which = parse_hist(&pai->inp, &s)) >= 0 ) {
+		while ( ' ' == *s )
+			s++;
+		for ( st = 0; stats[st]; st++ ) {
+			if ( !strcmp(s, stats[st]) ) {
+				pai->dpvt = (void*)(long)(which<<8 | st);
+				return 0;
+			}
+		}
+	}
+	recGblRecordError(S_db_badField, (void*)pai,
+		"devSpearTimestampLatency (init_record) INP must be @LATENCY|JITTER MEAN|RMS|MIN|MAX|COUNT|MISSED");
+	return S_db_badField;
+}
+
+static long read_ai_lat(aiRecord *pai)
+{
+SpearTimestampLatencyStats st;
+int which = (int)(long)pai->dpvt >> 8;
+	if ( spearTimestampGetLatencyStats(which, &st) ) {
+		recGblSetSevr(pai, READ_ALARM, INVALID_ALARM);
+		return 2;
+	}
+	switch ( (int)(long)pai->dpvt & 0xff ) {
+		case LAT_MEAN:   pai->val = st.mean;                 break;
+		case LAT_RMS:    pai->val = st.rms;                  break;
+		case LAT_MIN:    pai->val = (double)st.min;          break;
+		case LAT_MAX:    pai->val = (double)st.max;          break;
+		case LAT_COUNT:  pai->val = (double)st.count;        break;
+		default:         pai->val = (double)st.missed;       break;
+	}
+	pai->udf = FALSE;
+	return 2;	/* don't convert */
+}
+
+static long init_record_hist(waveformRecord *pwf)
+{
+char *s;
+int   which;
+	if ( (which = parse_hist(&pwf->inp, &s)) < 0 ) {
+		recGblRecordError(S_db_badField, (void*)pwf,
+			"devSpearTimestampHistogram (init_record) INP must be @LATENCY or @JITTER");
+		return S_db_badField;
+	}
+	if ( DBF_LONG != pwf->ftvl && DBF_ULONG != pwf->ftvl ) {
+		recGblRecordError(S_db_badField, (void*)pwf,
+			"devSpearTimestampHistogram (init_record) FTVL must be LONG or ULONG");
+		return S_db_badField;
+	}
+	pwf->dpvt = (void*)(long)which;
+	return 0;
+}
+
+static long read_wf_hist(waveformRecord *pwf)
+{
+int n = spearTimestampGetHistogram((int)(long)pwf->dpvt, (epicsUInt32*)pwf->bptr, pwf->nelm);
+	if ( n < 0 ) {
+		recGblSetSevr(pwf, READ_ALARM, INVALID_ALARM);
+		return 0;
+	}
+	pwf->nord = n;
+	return 0;
+}
+
 static long init_record(aiRecord *prec)
 {
     return(0);
 }
 
+static long init_record_src(aiRecord *pai)
+{
+char *s;
+int   src = -1;
+	if ( INST_IO == pai->inp.type && (s = pai->inp.value.instio.string) ) {
+		while ( ' ' == *s )
+			s++;
+		if ( !strncmp(s, "SYNC", 4) ) {
+			src = 8;
+		} else if ( !strncmp(s, "EVENT", 5) ) {
+			src = atoi(s+5);
+			/* the card raises no interrupt for event 7 */
+			if ( src < 0 || src >= SPEAR_TIMESTAMP_EVENT_NUM )
+				src = -1;
+		}
+	}
+	if ( src < 0 ) {
+		recGblRecordError(S_db_badField, (void*)pai,
+			"devSpearTimestampSource (init_record) INP must be @SYNC or @EVENT<0..6>");
+		return S_db_badField;
+	}
+	pai->dpvt = (void*)(long)src;
+	return 0;
+}
+
+static long get_ioint_info_src(int cmd, aiRecord *pai, IOSCANPVT *ppvt)
+{
+	return spearTimestampGetIoscan( (int)(long)pai->dpvt, ppvt ) ? -1 : 0;
+}
+
+static long read_ai_src(aiRecord *pai)
+{
+SpearTimestamp ts;
+	if ( spearTimestampGetSourceTime( (int)(long)pai->dpvt, &ts ) ) {
+		recGblSetSevr(pai, READ_ALARM, INVALID_ALARM);
+		return 2;
+	}
+	spearTimestampSetRecordTime((dbCommon*)pai, ts, 1);
+	pai->val = (double)ts;
+	pai->udf = FALSE;
+	return 2;	/* don't convert */
+}
+
 static long read_ai(aiRecord *pai)
 {
 double nval;
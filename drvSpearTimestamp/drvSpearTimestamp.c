@@ -7,8 +7,18 @@
 #include "errlog.h"
 #include "devBusMapped.h"
 #include "iocsh.h"
+#include "epicsAtomic.h"
+#include "epicsInterrupt.h"
+#include "epicsMutex.h"
+#include "epicsThread.h"
+#include "generalTimeSup.h"
+#include "dbScan.h"
 #include "epicsExport.h"
 
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
 #define myprintf errlogPrintf
 
 typedef volatile epicsUInt32 TSSMRegister;
@@ -37,6 +47,122 @@ static epicsUInt32	   tssmVME;
 int             	   tssmIRQVector = 0, tssmIRQLevel = 0;
 static DevBusMappedDev devBM = 0;
 
+/* Software TSSM (drvSpearTimestampSimRegister): the registers live
+ * in memory and a thread plays the card, raising the sync and event
+ * interrupts through tssmWrap.
+ */
+typedef struct TSSMSimRec_ {
+	TSSMRegsRec		regs;
+	double			rate;		/* ticks per second */
+	unsigned		events;		/* as of the last tick, for edges */
+	unsigned long	ticks;
+	unsigned long	resyncs;	/* fell behind by more than a second */
+	unsigned long	wraps;		/* calls of tssmWrap */
+	double			wrapSum, wrapMax;	/* time in tssmWrap, us */
+} TSSMSimRec;
+
+static TSSMSimRec	  *tssmSim = 0;
+
+/* CPU timebase, tbkHz ticks per millisecond */
+static unsigned        tbkHz;
+
+static __inline__ unsigned long
+tssmTB()
+{
+#if defined(__rtems__) && defined(__PPC__)
+unsigned long rval;
+	asm volatile("mftb %0":"=r"(rval));	
+	return rval;
+#else
+	return (unsigned long)epicsMonotonicGet();
+#endif
+}
+
+/* The timestamp as of the last sync, latched by the tick ISR so that
+ * readers need no VME access; seq is odd while the ISR updates it.
+ */
+typedef struct TSSMCacheRec_ {
+	volatile unsigned	seq;
+	SpearTimestamp		ts;
+	unsigned long		tb;		/* timebase at the sync */
+	int					valid;	/* TS_VALID was set in the CSR */
+} TSSMCacheRec;
+
+static TSSMCacheRec		tssmCache;
+static unsigned long	tbPerTick   = 0;	/* measured; 0 => no cache, read the TSSM */
+static unsigned long	tbPerClk256 = 0;	/* timebase per 256 timer1 clocks */
+static int				tssmConnected = 0;
+
+/* readers trust the cache for this many ticks after the last sync */
+#define TSSM_CACHE_TICKS	4
+
+/* Latency monitor, kept by tssmWrap on every sync: ISR entry delay
+ * (timer1 at entry) and the deviation of the interval between entries
+ * from the tick period, in us. Only the ISR writes these; readers copy
+ * without a lock and ask the ISR to clear them.
+ */
+typedef struct TSSMHistRec_ {
+	unsigned long		bins[SPEAR_TIMESTAMP_HIST_BINS];
+	unsigned long		count;
+	long				min, max;
+	long long			sum;
+	unsigned long long	sumsq;
+} TSSMHistRec;
+
+static TSSMHistRec		tssmHist[SPEAR_TIMESTAMP_HIST_NUM];
+static unsigned long	tssmHistMissed = 0;		/* intervals > 1.5 ticks, not binned */
+static volatile int		tssmHistClear  = 0;
+static unsigned long	tssmHistLastTb;
+static int				tssmHistHaveLast = 0;
+static unsigned long	tbNominal  = 0;			/* nominal tick in timebase units */
+static unsigned long	usPerTb16  = 0;			/* us per timebase tick, 16 bit fraction */
+
+/* Linear map SpearTimestamp -> epicsTimeStamp about the point
+ * (ts0, t0), refreshed by tssmCalTask; seq is odd during an update.
+ * Conversions further than maxTicks from ts0 fail -- the model is
+ * stale or the timestamp counter was reset/rolled over.
+ */
+typedef struct TSSMTimeModelRec_ {
+	volatile unsigned	seq;
+	SpearTimestamp		ts0;
+	epicsTimeStamp		t0;
+	unsigned long long	nsPerTick16;	/* ns per tick, 16 bit fraction */
+	SpearTimestamp		maxTicks;
+	int					valid;
+} TSSMTimeModelRec;
+
+#define TSSM_NS_PER_TICK16	(((unsigned long long)(1000000000/SPEAR_TIMESTAMP_RATE))<<16)
+
+static TSSMTimeModelRec	tssmModel;
+static int				tssmTimePrio = 0;		/* 0: no generalTime provider */
+static double			tssmCalPeriod = 10.;	/* seconds */
+static unsigned long	tssmCalCount  = 0;
+static unsigned long	tssmCalResets = 0;		/* counter went back or jumped */
+
+/* Interrupt subscribers. tssmWrap walks the table without a lock;
+ * slots are filled/cleared with interrupts off and never move.
+ * A slot is in use while its mask is nonzero.
+ */
+typedef struct TSSMSubscriberRec_ {
+	void		(*isr)(void*, unsigned);
+	void		*arg;
+	unsigned	mask;
+	unsigned long	calls;
+} TSSMSubscriberRec;
+
+static TSSMSubscriberRec	tssmSubs[TSSM_MAX_SUBSCRIBERS];
+static int					tssmNumSubs = 0;	/* slots ever used */
+static unsigned				themask = 0;		/* OR of all subscriber masks */
+static epicsMutexId			tssmSubsLock = 0;	/* serializes (un)subscribing */
+
+/* I/O Intr scan lists and the timestamp as of the last interrupt,
+ * per source; index is the bit number in the TSSM_INT_XXX mask
+ */
+static IOSCANPVT		tssmIoscan[TSSM_INT_NUM];
+static SpearTimestamp	tssmSourceTs[TSSM_INT_NUM];
+static unsigned long	tssmSourceCnt[TSSM_INT_NUM];
+static unsigned			tssmScanMask = 0;
+
 #define TSSM_CSR_RS232_TS			(1<<25)
 #define TSSM_CSR_CLK_SEL_INT		(1<<24)
 #define TSSM_CSR_TS_VALID			(1<<23)
@@ -58,7 +184,7 @@ static DevBusMappedDev devBM = 0;
 #define TSSM_CSR_SYNC2_OUT_ENA		(1<<1)
 #define TSSM_CSR_SYNC1_OUT_ENA		(1<<0)
 
-#define TSSM_INT_MASK				(0x17f) /* SYNC and events 0..7 */
+#define TSSM_INT_MASK				(0x17f) /* SYNC and events 0..6 */
 
 #define EVENT_MASK ((1<<SPEAR_TIMESTAMP_EVENT_NUM)-1)
 
@@ -86,24 +212,210 @@ static DevBusMappedAccessRec tssmIO = {
 };
 
 
-int
-spearTimestampGetCurrent(SpearTimestamp *pres)
+/* read hi/lo, again if lo carried into hi in between */
+static SpearTimestamp
+tssmReadTs()
 {
-epicsUInt32 hi,lo;
+epicsUInt32 hi,lo,hi2;
+	hi  = in_be32(&tssm->tsHi);
+	lo  = in_be32(&tssm->tsLo);
+	hi2 = in_be32(&tssm->tsHi);
+	if ( hi2 != hi ) {
+		hi = hi2;
+		lo = in_be32(&tssm->tsLo);
+	}
+	return (((SpearTimestamp)hi)<<32) | ((SpearTimestamp)lo);
+}
+
+static __inline__ void
+tssmHistAdd(TSSMHistRec *h, long v, int bin)
+{
+	if ( bin < 0 )
+		bin = 0;
+	else if ( bin >= SPEAR_TIMESTAMP_HIST_BINS )
+		bin = SPEAR_TIMESTAMP_HIST_BINS - 1;
+	h->bins[bin]++;
+	if ( !h->count || v < h->min )
+		h->min = v;
+	if ( !h->count || v > h->max )
+		h->max = v;
+	h->count++;
+	h->sum   += v;
+	h->sumsq += (unsigned long long)((long long)v * v);
+}
+
+/* on the sync interrupt; 'tb'/'clks' as read at ISR entry */
+static void
+tssmMonitor(unsigned long tb, epicsUInt32 clks)
+{
+unsigned long period = tbPerTick ? tbPerTick : tbNominal;
+unsigned long d;
+long          us;
+int           i;
+
+	if ( tssmHistClear ) {
+		for ( i=0; i<SPEAR_TIMESTAMP_HIST_NUM; i++ )
+			memset( &tssmHist[i], 0, sizeof(tssmHist[i]) );
+		tssmHistMissed   = 0;
+		tssmHistHaveLast = 0;
+		tssmHistClear    = 0;
+	}
+
+	us = clks / (TSSM_CLOCK_KHZ/1000);
+	tssmHistAdd( &tssmHist[SPEAR_TIMESTAMP_HIST_LATENCY], us, us );
+
+	if ( tssmHistHaveLast ) {
+		d = tb - tssmHistLastTb;
+		if ( d > period + (period >> 1) ) {
+			tssmHistMissed++;
+		} else if ( d >= period ) {
+			us = (long)(((unsigned long long)(d - period) * usPerTb16) >> 16);
+			tssmHistAdd( &tssmHist[SPEAR_TIMESTAMP_HIST_JITTER], us, SPEAR_TIMESTAMP_HIST_BINS/2 + us );
+		} else {
+			us = -(long)(((unsigned long long)(period - d) * usPerTb16) >> 16);
+			tssmHistAdd( &tssmHist[SPEAR_TIMESTAMP_HIST_JITTER], us, SPEAR_TIMESTAMP_HIST_BINS/2 + us );
+		}
+	}
+	tssmHistLastTb   = tb;
+	tssmHistHaveLast = 1;
+}
+
+/* on the sync interrupt, before any subscriber runs */
+static void
+tssmLatch(unsigned long tb, epicsUInt32 clks)
+{
+int            valid = (in_be32(&tssm->csr) & TSSM_CSR_TS_VALID) != 0;
+SpearTimestamp ts   = tssmReadTs();
+long           err;
+
+	/* backdate to the sync itself */
+	tb -= (clks * tbPerClk256) >> 8;
+
+	/* track the actual tick period from consecutive syncs */
+	if ( tssmCache.seq && tssmCache.valid && valid && ts == tssmCache.ts + 1 ) {
+		err = (long)(tb - tssmCache.tb) - (long)tbPerTick;
+		tbPerTick += err/16;
+	}
+
+	tssmCache.seq++;
+	epicsAtomicWriteMemoryBarrier();
+	tssmCache.ts    = ts;
+	tssmCache.tb    = tb;
+	tssmCache.valid = valid;
+	epicsAtomicWriteMemoryBarrier();
+	tssmCache.seq++;
+}
+
+/* Served from the cache while the tick ISR runs, counting the ticks
+ * since the last sync; from the TSSM otherwise. If 'pfrac16' is given
+ * it gets the part of the current tick elapsed (16 bit fraction), 0
+ * when read from the TSSM.
+ */
+static int
+tssmGetCurrent(SpearTimestamp *pres, unsigned long *pfrac16)
+{
+unsigned       seq;
+SpearTimestamp ts;
+unsigned long  tb, elapsed, period;
+int            valid, tries;
 	if ( !tssm ) {
 		*pres = SPEAR_TIMESTAMP_INVALID;
 		return -1;
 	}
+	for ( tries = 0; (period = tbPerTick) && tries < 4; tries++ ) {
+		seq   = tssmCache.seq;
+		epicsAtomicReadMemoryBarrier();
+		ts    = tssmCache.ts;
+		tb    = tssmCache.tb;
+		valid = tssmCache.valid;
+		epicsAtomicReadMemoryBarrier();
+		if ( (seq & 1) || seq != tssmCache.seq )
+			continue;
+		elapsed = tssmTB() - tb;
+		if ( !seq || elapsed >= TSSM_CACHE_TICKS*period )
+			break;	/* the ISR is not running */
+		if ( !valid )
+			break;
+		while ( elapsed >= period ) {
+			ts++;
+			elapsed -= period;
+		}
+		if ( pfrac16 )
+			*pfrac16 = (unsigned long)(((unsigned long long)elapsed << 16) / period);
+		*pres = ts;
+		return 0;
+	}
+	if ( pfrac16 )
+		*pfrac16 = 0;
 	if ( (in_be32(&tssm->csr) & TSSM_CSR_TS_VALID) ) {
-		hi = in_be32(&tssm->tsHi);
-	    lo = in_be32(&tssm->tsLo);
-		*pres = (((SpearTimestamp)hi)<<32) | ((SpearTimestamp)lo);
+		*pres = tssmReadTs();
 		return 0;
 	}
 	*pres = SPEAR_TIMESTAMP_INVALID;
 	return -2;
 }
 
+int
+spearTimestampGetCurrent(SpearTimestamp *pres)
+{
+	return tssmGetCurrent(pres, 0);
+}
+
+/* 'ts' plus 'frac16' of a tick through the model */
+static int
+tssmToEpicsTime(SpearTimestamp ts, unsigned long frac16, epicsTimeStamp *pt)
+{
+TSSMTimeModelRec m;
+SpearTimestamp   d;
+unsigned long long ns, fns;
+int              tries;
+	for ( tries = 0; tries < 4; tries++ ) {
+		m.seq = tssmModel.seq;
+		epicsAtomicReadMemoryBarrier();
+		m.ts0         = tssmModel.ts0;
+		m.t0          = tssmModel.t0;
+		m.nsPerTick16 = tssmModel.nsPerTick16;
+		m.maxTicks    = tssmModel.maxTicks;
+		m.valid       = tssmModel.valid;
+		epicsAtomicReadMemoryBarrier();
+		if ( !(m.seq & 1) && m.seq == tssmModel.seq )
+			break;
+	}
+	if ( tries >= 4 || !m.valid || SPEAR_TIMESTAMP_INVALID == ts )
+		return -1;
+	fns = ((unsigned long long)frac16 * m.nsPerTick16) >> 32;
+
+	/* no divisions; at most a few seconds either side of t0 */
+	pt->secPastEpoch = m.t0.secPastEpoch;
+	if ( ts >= m.ts0 ) {
+		if ( (d = ts - m.ts0) > m.maxTicks )
+			return -1;
+		ns = ((d * m.nsPerTick16) >> 16) + fns + m.t0.nsec;
+		while ( ns >= 1000000000ULL ) {
+			ns -= 1000000000ULL;
+			pt->secPastEpoch++;
+		}
+	} else {
+		if ( (d = m.ts0 - ts) > m.maxTicks )
+			return -1;
+		d  = ((d * m.nsPerTick16) >> 16) - fns;
+		ns = m.t0.nsec;
+		while ( d > ns ) {
+			ns += 1000000000ULL;
+			pt->secPastEpoch--;
+		}
+		ns -= d;
+	}
+	pt->nsec = (epicsUInt32)ns;
+	return 0;
+}
+
+int
+spearTimestampToEpicsTime(SpearTimestamp ts, epicsTimeStamp *pt)
+{
+	return tssmToEpicsTime(ts, 0, pt);
+}
+
 SpearSmallTimestamp
 spearSmallTimestampGetCurrent()
 {
@@ -117,6 +429,15 @@ spearTimestampSetRecordTime(dbCommon *pr, SpearTimestamp tstamp, int doAdjSecs)
 {
 SpearTimestamp rval = SPEAR_TIMESTAMP_INVALID;
 	if ( epicsTimeEventDeviceTime == pr->tse ) {
+		if ( tssmTimePrio ) {
+			/* real time from the model; plain current time if it can't */
+			if ( spearTimestampToEpicsTime(tstamp, &pr->time) )
+				epicsTimeGetEvent(&pr->time, epicsTimeEventCurrentTime);
+			/* same return value as without the model */
+			if ( doAdjSecs )
+				spearTimestampGetCurrent( &rval );
+			return rval;
+		}
 		epicsTimeGetEvent(&pr->time, epicsTimeEventCurrentTime);
 		pr->time.nsec = spearTimestampToEpicsNsec(tstamp);
 		if ( doAdjSecs ) {
@@ -133,6 +454,11 @@ spearTimestampSetRecordTimeCurrent(dbCommon *pr)
 {
 SpearTimestamp rval = SPEAR_TIMESTAMP_INVALID;
 	if ( epicsTimeEventDeviceTime == pr->tse ) {
+		if ( tssmTimePrio ) {
+			if ( spearTimestampGetCurrent( &rval ) || spearTimestampToEpicsTime(rval, &pr->time) )
+				epicsTimeGetEvent(&pr->time, epicsTimeEventCurrentTime);
+			return rval;
+		}
 		epicsTimeGetEvent(&pr->time, epicsTimeEventCurrentTime);
 		/* should we preserve the original nsecs in case this fails? */
 		spearTimestampGetCurrent( &rval );
@@ -145,7 +471,11 @@ int drvSpearTimestampReport(int level)
 {
 	if ( tssm ) {
 		epicsUInt32 csr = in_be32( &tssm->csr );
-		myprintf("TSSM Driver; module found @%p (VME address A24: 0x%08x)\n",
+		if ( tssmSim )
+			myprintf("TSSM Driver; software TSSM @%p, %.1f ticks/s, %lu ticks, %lu resyncs\n",
+				tssm, tssmSim->rate, tssmSim->ticks, tssmSim->resyncs);
+		else
+			myprintf("TSSM Driver; module found @%p (VME address A24: 0x%08x)\n",
 				tssm, tssmVME);
 		if ( level > 0 ) {
 			myprintf("  Card is in");
@@ -161,6 +491,30 @@ int drvSpearTimestampReport(int level)
 				myprintf("Rear");
 			}
 			myprintf(" IO configured\n");
+			if ( tbPerTick )
+				myprintf("  Timestamp cached on each sync; tick %lu timebase ticks (%u kHz)\n",
+						tbPerTick, tbkHz);
+			else
+				myprintf("  Timestamp read from the card\n");
+			myprintf("  Interrupt sources enabled: 0x%03x\n", themask);
+			if ( tssmTimePrio )
+				myprintf("  generalTime provider (priority %i); model %s, %.6f ns/tick, %lu calibrations, %lu resets\n",
+					tssmTimePrio, tssmModel.valid ? "valid" : "INVALID",
+					(double)tssmModel.nsPerTick16/65536., tssmCalCount, tssmCalResets);
+		}
+		if ( level > 1 ) {
+		int i;
+			for ( i=0; i<tssmNumSubs; i++ ) {
+				if ( tssmSubs[i].mask )
+					myprintf("    ISR %p(%p), mask 0x%03x: %lu calls\n",
+						tssmSubs[i].isr, tssmSubs[i].arg, tssmSubs[i].mask, tssmSubs[i].calls);
+			}
+			for ( i=0; i<TSSM_INT_NUM; i++ ) {
+				if ( tssmScanMask & (1<<i) )
+					myprintf("    I/O Intr on %s%i: %lu scans\n",
+						TSSM_INT_SYNC == (1<<i) ? "SYNC" : "EVENT",
+						TSSM_INT_SYNC == (1<<i) ? 0 : i, tssmSourceCnt[i]);
+			}
 		}
 		if ( csr & TSSM_CSR_TS_SYNC_ERR ) {
 			myprintf("  WARNING: Sync error detected\n");
@@ -257,32 +611,86 @@ cleanup:
 	}
 	tssmIRQVector = vector;
 	tssmIRQLevel  = level;
+	if ( !tssmSubsLock )
+		tssmSubsLock = epicsMutexMustCreate();
 
 	return 0;
 }
 
-static void (*theisr)() = 0;
-static unsigned themask = 0;
-
 static void tssmWrap(void *arg)
 {
 unsigned mask = in_be32( &tssm->intStatus );
+unsigned raised;
+int      i, n;
+unsigned long tb;
+epicsUInt32   clks;
 	
-	if ( theisr )
-		theisr(arg, mask & TSSM_INT_MASK);
+	if ( (mask & TSSM_INT_SYNC) ) {
+		tb   = tssmTB();
+		clks = in_be32( &tssm->timer1 );
+		if ( tbPerTick )
+			tssmLatch(tb, clks);
+		if ( usPerTb16 )
+			tssmMonitor(tb, clks);
+	}
+
+	n = tssmNumSubs;
+	epicsAtomicReadMemoryBarrier();
+	for ( i=0; i<n; i++ ) {
+		if ( (raised = mask & tssmSubs[i].mask) ) {
+			tssmSubs[i].calls++;
+			tssmSubs[i].isr(tssmSubs[i].arg, raised);
+		}
+	}
 
 	out_be32( &tssm->intStatus, mask );
 }
 
+/* connect tssmWrap once, for the cache and the subscribers alike */
+static int
+tssmConnect()
+{
+int rval;
+	if ( tssmConnected )
+		return 0;
+	if ( !tssmSim && (rval = devConnectInterruptVME(tssmIRQVector, tssmWrap, 0) ) )
+		return rval;
+	tssmConnected = 1;
+	/* clear pending irqs */
+	out_be32( &tssm->intStatus, 0xffffffff );
+	/* enable at TSSM */
+	out_be32( &tssm->csr, in_be32( &tssm->csr ) | TSSM_CSR_IRQ_ENA );
+	if ( !tssmSim )
+		devEnableInterruptLevelVME(tssmIRQLevel);
+	return 0;
+}
+
+static void
+tssmEnable()
+{
+unsigned en = themask | (tbPerTick ? TSSM_INT_SYNC : 0);
+	out_be32( &tssm->intEnable, en );
+}
+
+static void
+tssmRecompute()
+{
+unsigned m = 0;
+int      i;
+	for ( i=0; i<tssmNumSubs; i++ )
+		m |= tssmSubs[i].mask;
+	themask = m;
+}
+
 int
 drvSpearTimestampConnectISR(void (*isr)(void*, unsigned),void *arg, unsigned mask)
 {
-int rval;
+int rval = 0, i, slot, key;
 	if ( !tssm ) {
 		errlogPrintf("drvSpearTimestamp: no TSSM registered\n");
 		return -1;
 	}
-	if ( !mask && isr ) {
+	if ( !(mask & TSSM_INT_MASK) && isr ) {
 		errlogPrintf("must supply interrupt sources\n");
 		return -1;
 	} 
@@ -291,29 +699,117 @@ int rval;
 				tssmIRQVector, tssmIRQLevel);
 		return -1;
 	}
+	epicsMutexLock( tssmSubsLock );
 	if ( isr ) {
-		if ( (rval = devConnectInterruptVME(tssmIRQVector, tssmWrap, arg) ) )
-			return rval;
-		themask = mask & TSSM_INT_MASK;
-		theisr  = isr;
-		/* clear pending irqs */
-		out_be32( &tssm->intStatus, 0xffffffff );
-		/* enable at TSSM */
-		out_be32( &tssm->csr, in_be32( &tssm->csr ) | TSSM_CSR_IRQ_ENA );
-		out_be32( &tssm->intEnable, themask );
-		devEnableInterruptLevelVME(tssmIRQLevel);
+		if ( (rval = tssmConnect()) )
+			goto bail;
+		/* same isr/arg again just changes the mask */
+		for ( i=0, slot=-1; i<tssmNumSubs; i++ ) {
+			if ( tssmSubs[i].mask && tssmSubs[i].isr == isr && tssmSubs[i].arg == arg ) {
+				slot = i;
+				break;
+			}
+			if ( slot < 0 && !tssmSubs[i].mask )
+				slot = i;
+		}
+		if ( slot < 0 ) {
+			if ( tssmNumSubs >= TSSM_MAX_SUBSCRIBERS ) {
+				errlogPrintf("drvSpearTimestamp: too many interrupt subscribers (max %i)\n",
+						TSSM_MAX_SUBSCRIBERS);
+				rval = -1;
+				goto bail;
+			}
+			slot = tssmNumSubs;
+		}
+		key = epicsInterruptLock();
+			tssmSubs[slot].isr  = isr;
+			tssmSubs[slot].arg  = arg;
+			tssmSubs[slot].mask = mask & TSSM_INT_MASK;
+			if ( slot == tssmNumSubs ) {
+				epicsAtomicWriteMemoryBarrier();
+				tssmNumSubs++;
+			}
+			tssmRecompute();
+			tssmEnable();
+		epicsInterruptUnlock(key);
 	} else {
-		/* leave VME level on in case other devices use it! */
-		themask = 0;
-		theisr  = 0;
-		out_be32( &tssm->csr, in_be32( &tssm->csr ) & ~TSSM_CSR_IRQ_ENA );
-		out_be32( &tssm->intEnable, 0 );
-		out_be32( &tssm->intStatus, TSSM_INT_MASK );
-		rval = devDisconnectInterruptVME(tssmIRQVector, tssmWrap);
+		/* drop the subscribers with this arg (all of them, with a NULL arg
+		 * if only one has ever subscribed -- that used to be the semantics)
+		 */
+		key = epicsInterruptLock();
+			for ( i=0; i<tssmNumSubs; i++ ) {
+				if ( tssmSubs[i].arg == arg || ( !arg && 1 == tssmNumSubs ) )
+					tssmSubs[i].mask = 0;
+			}
+			tssmRecompute();
+			tssmEnable();
+		epicsInterruptUnlock(key);
+		if ( !themask && !tbPerTick && tssmConnected ) {
+			/* leave VME level on in case other devices use it! */
+			out_be32( &tssm->csr, in_be32( &tssm->csr ) & ~TSSM_CSR_IRQ_ENA );
+			out_be32( &tssm->intStatus, TSSM_INT_MASK );
+			if ( !tssmSim )
+				rval = devDisconnectInterruptVME(tssmIRQVector, tssmWrap);
+			tssmConnected = 0;
+		}
 	}
+bail:
+	epicsMutexUnlock( tssmSubsLock );
 	return rval;
 }
 
+/* the driver's own subscriber: latch the timestamp and scan the
+ * records waiting for each source
+ */
+static void
+tssmScanIsr(void *arg, unsigned mask)
+{
+SpearTimestamp ts;
+int            i;
+	ts = ( in_be32(&tssm->csr) & TSSM_CSR_TS_VALID ) ? tssmReadTs() : SPEAR_TIMESTAMP_INVALID;
+	for ( i=0; i<TSSM_INT_NUM; i++ ) {
+		if ( mask & (1<<i) ) {
+			tssmSourceTs[i] = ts;
+			tssmSourceCnt[i]++;
+			scanIoRequest( tssmIoscan[i] );
+		}
+	}
+}
+
+int
+spearTimestampGetIoscan(int source, IOSCANPVT *ppvt)
+{
+int key;
+	if ( source < 0 || source >= TSSM_INT_NUM || !((1<<source) & TSSM_INT_MASK) )
+		return -1;
+	if ( !tssmIoscan[source] )
+		scanIoInit( &tssmIoscan[source] );
+	*ppvt = tssmIoscan[source];
+	if ( !(tssmScanMask & (1<<source)) ) {
+		if ( drvSpearTimestampConnectISR(tssmScanIsr, (void*)tssmIoscan, tssmScanMask | (1<<source)) )
+			return -1;
+		key = epicsInterruptLock();
+			tssmScanMask |= (1<<source);
+		epicsInterruptUnlock(key);
+	}
+	return 0;
+}
+
+int
+spearTimestampGetSourceTime(int source, SpearTimestamp *pres)
+{
+int key;
+	if ( source < 0 || source >= TSSM_INT_NUM || !(tssmScanMask & (1<<source)) ) {
+		*pres = SPEAR_TIMESTAMP_INVALID;
+		return -1;
+	}
+	/* 64-bit value; keep the ISR out */
+	key = epicsInterruptLock();
+		*pres = tssmSourceTs[source];
+	epicsInterruptUnlock(key);
+	return SPEAR_TIMESTAMP_INVALID == *pres ? -2 : 0;
+}
+
 SpearEvents
 spearTimestampGetEvents()
 {
@@ -339,10 +835,6 @@ unsigned flags;
 	return flags;
 }
 
-#if defined(__rtems__) && defined(__PPC__)
-static unsigned tbkHz;
-#endif
-
 unsigned long
 spearTimestampTBbackdate()
 {
@@ -355,8 +847,14 @@ unsigned flags, rval, tssmTime;
 	tssmTime *= tbkHz;
 	return rval - tssmTime/TSSM_CLOCK_KHZ;
 #else
-#warning TBbackdate not implemented on your CPU and/or OS
-	return 0xdeadbeef;
+unsigned long rval;
+epicsUInt32   tssmTime;
+int           key;
+	key = epicsInterruptLock();
+		rval     = tssmTB();
+		tssmTime = in_be32( &tssm->timer1 );
+	epicsInterruptUnlock(key);
+	return rval - (unsigned long)(((unsigned long long)tssmTime * tbkHz) / TSSM_CLOCK_KHZ);
 #endif
 }
 
@@ -366,6 +864,360 @@ spearTimestampGetUsecSinceTick()
 	return in_be32( &tssm->timer1 ) / (TSSM_CLOCK_KHZ/1000);
 }
 
+static void
+tssmModelSet(SpearTimestamp ts, epicsTimeStamp *pt, unsigned long long k, int valid)
+{
+int key;
+	key = epicsInterruptLock();
+		tssmModel.seq++;
+		epicsAtomicWriteMemoryBarrier();
+		tssmModel.ts0         = ts;
+		if ( pt )
+			tssmModel.t0      = *pt;
+		tssmModel.nsPerTick16 = k;
+		tssmModel.maxTicks    = (SpearTimestamp)((2.*tssmCalPeriod + 1.) * SPEAR_TIMESTAMP_RATE);
+		tssmModel.valid       = valid;
+		epicsAtomicWriteMemoryBarrier();
+		tssmModel.seq++;
+	epicsInterruptUnlock(key);
+}
+
+/* Pair the timestamp with the time of the next best provider
+ * every tssmCalPeriod and fit the tick period in between. The
+ * reference time is taken back to the sync of the current tick,
+ * so that the pair is not off by the part of the tick elapsed.
+ */
+static void
+tssmCalTask(void *arg)
+{
+SpearTimestamp     ts, prevTs = SPEAR_TIMESTAMP_INVALID;
+epicsTimeStamp     now, prev;
+unsigned long long k = TSSM_NS_PER_TICK16;
+unsigned long      frac16;
+double             dt, meas;
+int                prio;
+	while ( 1 ) {
+		if ( generalTimeGetExceptPriority(&now, &prio, tssmTimePrio)
+		     || tssmGetCurrent(&ts, &frac16) ) {
+			tssmModelSet(0, 0, k, 0);
+			prevTs = SPEAR_TIMESTAMP_INVALID;
+		} else {
+			epicsTimeAddSeconds(&now, -1.0E-9 * (double)(((unsigned long long)frac16 * k) >> 32));
+			if ( SPEAR_TIMESTAMP_INVALID != prevTs ) {
+				dt = epicsTimeDiffInSeconds(&now, &prev);
+				if ( ts <= prevTs || ts - prevTs > 2*tssmModel.maxTicks || dt <= 0. ) {
+					/* the counter was reset or rolled over; start over */
+					tssmCalResets++;
+					k = TSSM_NS_PER_TICK16;
+				} else {
+					meas = dt * 1.0E9 * 65536. / (double)(ts - prevTs);
+					/* ignore outliers (the reference stepped) */
+					if ( meas > 0.9*TSSM_NS_PER_TICK16 && meas < 1.1*TSSM_NS_PER_TICK16 )
+						k += (long long)(meas - (double)k) / 4;
+				}
+			}
+			tssmModelSet(ts, &now, k, 1);
+			tssmCalCount++;
+			prevTs = ts;
+			prev   = now;
+		}
+		epicsThreadSleep(tssmCalPeriod);
+	}
+}
+
+int
+spearTimestampGetHistogram(int which, epicsUInt32 *buf, int nelm)
+{
+int i;
+	if ( which < 0 || which >= SPEAR_TIMESTAMP_HIST_NUM )
+		return -1;
+	if ( nelm > SPEAR_TIMESTAMP_HIST_BINS )
+		nelm = SPEAR_TIMESTAMP_HIST_BINS;
+	for ( i=0; i<nelm; i++ )
+		buf[i] = tssmHist[which].bins[i];
+	return nelm;
+}
+
+int
+spearTimestampGetLatencyStats(int which, SpearTimestampLatencyStats *p)
+{
+TSSMHistRec *h;
+unsigned long long sumsq;
+long long    sum;
+int          key;
+	if ( which < 0 || which >= SPEAR_TIMESTAMP_HIST_NUM )
+		return -1;
+	h = &tssmHist[which];
+	/* the 64-bit sums must be consistent with count */
+	key = epicsInterruptLock();
+		p->count = h->count;
+		p->min   = h->min;
+		p->max   = h->max;
+		sum      = h->sum;
+		sumsq    = h->sumsq;
+	epicsInterruptUnlock(key);
+	p->missed = tssmHistMissed;
+	if ( p->count ) {
+		p->mean = (double)sum / (double)p->count;
+		p->rms  = sqrt( (double)sumsq / (double)p->count );
+	} else {
+		p->mean = p->rms = 0.;
+	}
+	return 0;
+}
+
+void
+spearTimestampClearHistograms()
+{
+	tssmHistClear = 1;
+}
+
+int
+spearTimestampLatencyReport(int clear)
+{
+static const char *names[SPEAR_TIMESTAMP_HIST_NUM] = { "ISR entry delay", "Tick jitter" };
+SpearTimestampLatencyStats st;
+epicsUInt32 bins[SPEAR_TIMESTAMP_HIST_BINS];
+int         i, j, off;
+	if ( !usPerTb16 ) {
+		myprintf("TSSM latency monitor not running\n");
+		return -1;
+	}
+	for ( i=0; i<SPEAR_TIMESTAMP_HIST_NUM; i++ ) {
+		spearTimestampGetLatencyStats(i, &st);
+		spearTimestampGetHistogram(i, bins, SPEAR_TIMESTAMP_HIST_BINS);
+		off = SPEAR_TIMESTAMP_HIST_JITTER == i ? SPEAR_TIMESTAMP_HIST_BINS/2 : 0;
+		myprintf("%s (us): %lu samples, mean %.2f, rms %.2f, min %li, max %li\n",
+			names[i], st.count, st.mean, st.rms, st.min, st.max);
+		for ( j=0; j<SPEAR_TIMESTAMP_HIST_BINS; j++ ) {
+			if ( bins[j] )
+				myprintf("  %s%3i: %lu\n",
+					j == 0 && off ? "<=" : (j == SPEAR_TIMESTAMP_HIST_BINS-1 ? ">=" : "  "),
+					j - off, (unsigned long)bins[j]);
+		}
+	}
+	myprintf("Intervals > 1.5 ticks (not binned): %lu\n", tssmHistMissed);
+	if ( clear )
+		spearTimestampClearHistograms();
+	return 0;
+}
+
+/* the tick plus the time elapsed since it, not whole ticks */
+static int
+tssmTimeCurrent(epicsTimeStamp *pDest)
+{
+SpearTimestamp ts;
+unsigned long  frac16;
+	if ( tssmGetCurrent(&ts, &frac16) )
+		return -1;
+	return tssmToEpicsTime(ts, frac16, pDest) ? -1 : 0;
+}
+
+/* event n (1..TSSM_INT_NUM) is the last interrupt from source n-1 */
+static int
+tssmTimeEvent(epicsTimeStamp *pDest, int event)
+{
+SpearTimestamp ts;
+	if ( event == epicsTimeEventCurrentTime || event == epicsTimeEventBestTime )
+		return tssmTimeCurrent(pDest);
+	if ( event < 1 || event > TSSM_INT_NUM || spearTimestampGetSourceTime(event-1, &ts) )
+		return -1;
+	return spearTimestampToEpicsTime(ts, pDest) ? -1 : 0;
+}
+
+int
+spearTimestampTimeConfigure(int priority, double calPeriod)
+{
+	if ( !tssm ) {
+		errlogPrintf("drvSpearTimestamp: no TSSM registered\n");
+		return -1;
+	}
+	if ( calPeriod > 0. )
+		tssmCalPeriod = calPeriod;
+	if ( tssmTimePrio )
+		return 0;	/* just changed the period */
+	if ( priority <= 0 )
+		priority = 90;	/* ahead of NTP */
+	tssmTimePrio = priority;
+	tssmModelSet(0, 0, TSSM_NS_PER_TICK16, 0);
+	if ( !epicsThreadCreate("tssmCal", epicsThreadPriorityMedium,
+			epicsThreadGetStackSize(epicsThreadStackSmall), tssmCalTask, 0) ) {
+		errlogPrintf("drvSpearTimestamp: cannot create calibration thread\n");
+		tssmTimePrio = 0;
+		return -1;
+	}
+	generalTimeRegisterCurrentProvider("SpearTimestamp", priority, tssmTimeCurrent);
+	generalTimeRegisterEventProvider("SpearTimestamp", priority, tssmTimeEvent);
+	return 0;
+}
+
+/* one tick of the software TSSM; 'late' is ns past when it was due */
+static void
+tssmSimTick(epicsUInt64 late)
+{
+TSSMRegs       r = &tssmSim->regs;
+SpearTimestamp ts;
+unsigned       ev, pending;
+epicsUInt64    t0, t1;
+double         us;
+int            key;
+
+	ts = ((((SpearTimestamp)in_be32(&r->tsHi))<<32) | in_be32(&r->tsLo)) + 1;
+	out_be32( &r->tsLo, (epicsUInt32)ts );
+	out_be32( &r->tsHi, (epicsUInt32)(ts>>32) );
+	out_be32( &r->csr, in_be32( &r->csr ) | TSSM_CSR_TS_VALID );
+	tssmSim->ticks++;
+
+	/* an event interrupt on each rising event flag */
+	ev      = TSSM_EVENTS_GET( in_be32( &r->eventFlags ) );
+	pending = TSSM_INT_SYNC | (ev & ~tssmSim->events);
+	tssmSim->events = ev;
+
+	/* timer1 counts from the sync, i.e., from when the tick was due */
+	out_be32( &r->timer1, (epicsUInt32)(late * (TSSM_CLOCK_KHZ/1000) / 1000) );
+	out_be32( &r->intStatus, pending );
+
+	if ( tssmConnected && (in_be32( &r->csr ) & TSSM_CSR_IRQ_ENA)
+	     && (pending & in_be32( &r->intEnable )) ) {
+		key = epicsInterruptLock();
+			t0 = epicsMonotonicGet();
+			tssmWrap( 0 );
+			t1 = epicsMonotonicGet();
+		epicsInterruptUnlock(key);
+		us = (double)(t1 - t0) / 1000.;
+		tssmSim->wraps++;
+		tssmSim->wrapSum += us;
+		if ( us > tssmSim->wrapMax )
+			tssmSim->wrapMax = us;
+	}
+	out_be32( &r->intStatus, 0 );
+}
+
+static void
+tssmSimTask(void *arg)
+{
+epicsUInt64 period = (epicsUInt64)(1.0E9 / tssmSim->rate);
+epicsUInt64 next   = epicsMonotonicGet();
+epicsUInt64 now;
+	while ( 1 ) {
+		next += period;
+		now   = epicsMonotonicGet();
+		if ( now < next ) {
+			epicsThreadSleep( (double)(next - now) * 1.0E-9 );
+			now = epicsMonotonicGet();
+		} else if ( now - next > 1000000000ULL ) {
+			/* don't replay a second worth of ticks in a burst */
+			tssmSim->resyncs++;
+			next = now;
+		}
+		tssmSimTick( now > next ? now - next : 0 );
+	}
+}
+
+int
+drvSpearTimestampSimRegister(int master, double rate)
+{
+	if ( tssm ) {
+		errlogPrintf("drvSpearTimestampSimRegister: a TSSM is already registered\n");
+		return -1;
+	}
+	if ( rate <= 0. )
+		rate = SPEAR_TIMESTAMP_RATE;
+	if ( !(tssmSim = calloc(1, sizeof(*tssmSim))) ) {
+		errlogPrintf("drvSpearTimestampSimRegister: no memory\n");
+		return -1;
+	}
+	tssmSim->rate = rate;
+	tssm          = &tssmSim->regs;
+	out_be32( &tssm->csr, master ? TSSM_CSR_MASTER : 0 );
+
+	devBM = devBusMappedRegister( master ? "tssmMas" : "tssmSlv", (volatile void*)tssm );
+	if ( master ) {
+		devBusMappedRegisterIO( "tssmIO", &tssmIO );
+	}
+	isMaster = master ? 1 : 0;
+
+	/* stand-ins; the software TSSM never goes to devLib */
+	tssmIRQVector = 1;
+	tssmIRQLevel  = 1;
+	if ( !tssmSubsLock )
+		tssmSubsLock = epicsMutexMustCreate();
+
+	if ( !epicsThreadCreate("tssmSim", epicsThreadPriorityMax,
+			epicsThreadGetStackSize(epicsThreadStackSmall), tssmSimTask, 0) ) {
+		errlogPrintf("drvSpearTimestampSimRegister: cannot create thread\n");
+		return -1;
+	}
+	errlogPrintf("drvSpearTimestampSimRegister: software TSSM (%s) at %.1f ticks/s\n",
+			master ? "master" : "slave", rate);
+	return 0;
+}
+
+int
+drvSpearTimestampSimEvent(int num, int val)
+{
+unsigned flags;
+	if ( !tssmSim || num < 0 || num >= SPEAR_TIMESTAMP_EVENT_NUM )
+		return -1;
+	if ( isMaster )
+		return spearTimestampSetEvent(num, val);
+	/* what a slave would receive from the master */
+	epicsMutexLock( devBM->mutex );
+	flags = in_be32( &tssm->eventFlags );
+	if ( val )
+		flags |= (1<<num)<<16;
+	else
+		flags &= ~((1<<num)<<16);
+	out_be32( &tssm->eventFlags, flags );
+	epicsMutexUnlock( devBM->mutex );
+	return TSSM_EVENTS_GET(flags);
+}
+
+int
+spearTimestampBench(int loops)
+{
+SpearTimestamp ts = 0;
+epicsTimeStamp t;
+epicsUInt64    t0;
+double         ns;
+int            i;
+SpearTimestampLatencyStats st;
+	if ( !tssm ) {
+		myprintf("No TSSM card registered\n");
+		return -1;
+	}
+	if ( loops <= 0 )
+		loops = 100000;
+
+	t0 = epicsMonotonicGet();
+	for ( i=0; i<loops; i++ )
+		spearTimestampGetCurrent( &ts );
+	ns = (double)(epicsMonotonicGet() - t0) / loops;
+	myprintf("spearTimestampGetCurrent: %8.1f ns (%s)\n", ns, tbPerTick ? "cached" : "from the card");
+
+	t0 = epicsMonotonicGet();
+	for ( i=0; i<loops; i++ )
+		ts = tssmReadTs();
+	ns = (double)(epicsMonotonicGet() - t0) / loops;
+	myprintf("Timestamp read from the card: %8.1f ns\n", ns);
+
+	if ( tssmModel.valid ) {
+		t0 = epicsMonotonicGet();
+		for ( i=0; i<loops; i++ )
+			spearTimestampToEpicsTime( ts, &t );
+		ns = (double)(epicsMonotonicGet() - t0) / loops;
+		myprintf("spearTimestampToEpicsTime: %8.1f ns\n", ns);
+	}
+
+	if ( tssmSim && tssmSim->wraps )
+		myprintf("ISR dispatch (tssmWrap): %lu calls, mean %.2f us, max %.2f us\n",
+			tssmSim->wraps, tssmSim->wrapSum/tssmSim->wraps, tssmSim->wrapMax);
+	if ( !spearTimestampGetLatencyStats( SPEAR_TIMESTAMP_HIST_LATENCY, &st ) && st.count )
+		myprintf("ISR entry delay: mean %.2f us, max %li us (%lu ticks)\n",
+			st.mean, st.max, st.count);
+	return 0;
+}
+
 static int
 drvSpearTimestampInit()
 {
@@ -377,6 +1229,8 @@ epicsUInt32 csr;
 
 #if defined(__rtems__) && defined(__PPC__)
 	tbkHz = BSP_bus_frequency / BSP_time_base_divisor;
+#else
+	tbkHz = 1000000;	/* epicsMonotonicGet() counts ns */
 #endif
 
 	csr = in_be32( &tssm->csr );
@@ -397,6 +1251,21 @@ epicsUInt32 csr;
 	 */
 	if ( tssmIRQLevel )
 		out_be32( &tssm->csr, csr );
+
+	tbNominal = (unsigned long)(((unsigned long long)tbkHz * 1000) / SPEAR_TIMESTAMP_RATE);
+	usPerTb16 = (unsigned long)((1000ULL << 16) / tbkHz);
+
+	/* keep the timestamp cache on every sync if we may take interrupts */
+	if ( tssmIRQLevel && tssmIRQVector ) {
+		tbPerClk256 = (tbkHz << 8) / TSSM_CLOCK_KHZ;
+		tbPerTick   = (unsigned long)(((unsigned long long)tbkHz * 1000) / SPEAR_TIMESTAMP_RATE);
+		if ( tssmConnect() ) {
+			errlogPrintf("drvSpearTimestamp: cannot connect interrupt, timestamps read from the card\n");
+			tbPerTick = 0;
+		} else {
+			tssmEnable();
+		}
+	}
 	return 0;
 }
 
@@ -436,8 +1305,69 @@ static void drvSpearTimestampRegisterCallFunc(const iocshArgBuf *arg)
     drvSpearTimestampRegister(arg[0].ival, arg[1].ival, arg[2].ival);
 }
 
+/* spearTimestampTimeConfigure(int priority, double calPeriod) */
+static const iocshArg spearTimestampTimeConfigureArg0 = {"priority", iocshArgInt};
+static const iocshArg spearTimestampTimeConfigureArg1 = {"calPeriod", iocshArgDouble};
+static const iocshArg * const spearTimestampTimeConfigureArgs[2] = {
+    &spearTimestampTimeConfigureArg0, &spearTimestampTimeConfigureArg1};
+static const iocshFuncDef spearTimestampTimeConfigureFuncDef =
+    {"spearTimestampTimeConfigure",2,spearTimestampTimeConfigureArgs};
+static void spearTimestampTimeConfigureCallFunc(const iocshArgBuf *arg)
+{
+    spearTimestampTimeConfigure(arg[0].ival, arg[1].dval);
+}
+
+/* spearTimestampLatencyReport(int clear) */
+static const iocshArg spearTimestampLatencyReportArg0 = {"clear", iocshArgInt};
+static const iocshArg * const spearTimestampLatencyReportArgs[1] = {&spearTimestampLatencyReportArg0};
+static const iocshFuncDef spearTimestampLatencyReportFuncDef =
+    {"spearTimestampLatencyReport",1,spearTimestampLatencyReportArgs};
+static void spearTimestampLatencyReportCallFunc(const iocshArgBuf *arg)
+{
+    spearTimestampLatencyReport(arg[0].ival);
+}
+
+/* drvSpearTimestampSimRegister(int master, double rate) */
+static const iocshArg drvSpearTimestampSimRegisterArg0 = {"master", iocshArgInt};
+static const iocshArg drvSpearTimestampSimRegisterArg1 = {"rate", iocshArgDouble};
+static const iocshArg * const drvSpearTimestampSimRegisterArgs[2] = {
+    &drvSpearTimestampSimRegisterArg0, &drvSpearTimestampSimRegisterArg1};
+static const iocshFuncDef drvSpearTimestampSimRegisterFuncDef =
+    {"drvSpearTimestampSimRegister",2,drvSpearTimestampSimRegisterArgs};
+static void drvSpearTimestampSimRegisterCallFunc(const iocshArgBuf *arg)
+{
+    drvSpearTimestampSimRegister(arg[0].ival, arg[1].dval);
+}
+
+/* drvSpearTimestampSimEvent(int num, int val) */
+static const iocshArg drvSpearTimestampSimEventArg0 = {"num", iocshArgInt};
+static const iocshArg drvSpearTimestampSimEventArg1 = {"val", iocshArgInt};
+static const iocshArg * const drvSpearTimestampSimEventArgs[2] = {
+    &drvSpearTimestampSimEventArg0, &drvSpearTimestampSimEventArg1};
+static const iocshFuncDef drvSpearTimestampSimEventFuncDef =
+    {"drvSpearTimestampSimEvent",2,drvSpearTimestampSimEventArgs};
+static void drvSpearTimestampSimEventCallFunc(const iocshArgBuf *arg)
+{
+    drvSpearTimestampSimEvent(arg[0].ival, arg[1].ival);
+}
+
+/* spearTimestampBench(int loops) */
+static const iocshArg spearTimestampBenchArg0 = {"loops", iocshArgInt};
+static const iocshArg * const spearTimestampBenchArgs[1] = {&spearTimestampBenchArg0};
+static const iocshFuncDef spearTimestampBenchFuncDef =
+    {"spearTimestampBench",1,spearTimestampBenchArgs};
+static void spearTimestampBenchCallFunc(const iocshArgBuf *arg)
+{
+    spearTimestampBench(arg[0].ival);
+}
+
 LOCAL void drvSpearTimestampRegistrar(void) {
     iocshRegister(&drvSpearTimestampReportFuncDef,drvSpearTimestampReportCallFunc);
     iocshRegister(&drvSpearTimestampRegisterFuncDef,drvSpearTimestampRegisterCallFunc);
+    iocshRegister(&spearTimestampTimeConfigureFuncDef,spearTimestampTimeConfigureCallFunc);
+    iocshRegister(&spearTimestampLatencyReportFuncDef,spearTimestampLatencyReportCallFunc);
+    iocshRegister(&drvSpearTimestampSimRegisterFuncDef,drvSpearTimestampSimRegisterCallFunc);
+    iocshRegister(&drvSpearTimestampSimEventFuncDef,drvSpearTimestampSimEventCallFunc);
+    iocshRegister(&spearTimestampBenchFuncDef,spearTimestampBenchCallFunc);
 }
 epicsExportRegistrar(drvSpearTimestampRegistrar);
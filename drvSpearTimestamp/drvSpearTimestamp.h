@@ -4,6 +4,7 @@
 
 #include <epicsTime.h>
 #include <dbCommon.h>
+#include <dbScan.h>
 
 typedef unsigned long long SpearTimestamp;
 typedef int                SpearEvents;
@@ -31,6 +32,27 @@ int drvSpearTimestampIsMaster();
 int
 drvSpearTimestampRegister(epicsUInt32 vmeAddr, int vector, int level);
 
+/* Register a software TSSM instead of a card, e.g., on a host.
+ * Its registers live in memory; a thread advances the timestamp
+ * 'rate' times per second (<= 0: SPEAR_TIMESTAMP_RATE) and raises
+ * the sync and event interrupts through the driver's ISR.
+ * A master takes events from spearTimestampSetEvent().
+ */
+int
+drvSpearTimestampSimRegister(int master, double rate);
+
+/* set event 'num' on a software TSSM; on a slave this is what
+ * the master would send. RETURNS as spearTimestampSetEvent().
+ */
+int
+drvSpearTimestampSimEvent(int num, int val);
+
+/* time 'loops' (<= 0: 100000) timestamp reads and conversions
+ * and print them with the ISR dispatch/latency figures
+ */
+int
+spearTimestampBench(int loops);
+
 
 /* valid MASK bits */
 #define TSSM_INT_SYNC				(1<<8)
@@ -43,6 +65,11 @@ drvSpearTimestampRegister(epicsUInt32 vmeAddr, int vector, int level);
 #define TSSM_INT_EVENT6				(1<<6)
 #define TSSM_INT_EVENT7				(1<<7)
 
+/* number of interrupt sources; bit numbers of the above */
+#define TSSM_INT_NUM				9
+
+#define TSSM_MAX_SUBSCRIBERS		16
+
 /* 
  * Connect ISR. Supply a NULL function pointer to disconnect.
  * The driver will enable the interrupt after connecting and
@@ -52,12 +79,36 @@ drvSpearTimestampRegister(epicsUInt32 vmeAddr, int vector, int level);
  * not to interfere with other devices sharing the same level.
  *
  * The 'mask' argument selects interupt sources to activate.
- * A bitmask of raised interrupts is passed to the ISR.
+ * A bitmask of the raised interrupts in 'mask' is passed to the ISR.
+ *
+ * Up to TSSM_MAX_SUBSCRIBERS ISRs may be connected; each gets
+ * its own sources. Connecting the same isr/arg pair again changes
+ * its mask. Disconnecting (NULL isr) drops the ISRs connected
+ * with 'arg'.
  */
 int
 drvSpearTimestampConnectISR(void (*isr)(void*arg, unsigned mask),void *arg, unsigned mask);
 
+/* I/O Intr scan list for a TSSM interrupt source (bit number
+ * of a TSSM_INT_XXX, i.e., 0..6 for the events, 8 for SYNC;
+ * EVENT7 is not in the driver's interrupt mask).
+ * The first call for a source enables its interrupt.
+ * RETURNS 0 on success, -1 if the source is invalid or the
+ *         interrupt cannot be connected.
+ */
+int
+spearTimestampGetIoscan(int source, IOSCANPVT *ppvt);
+
+/* the timestamp as of the last interrupt from 'source';
+ * only for sources with an I/O Intr scan list.
+ * RETURNS as spearTimestampGetCurrent().
+ */
+int
+spearTimestampGetSourceTime(int source, SpearTimestamp *pres);
+
 /* read the current timestamp;
+ * while the driver takes TSSM interrupts this needs no VME access,
+ * the tick ISR caches the timestamp on every sync.
  * returns -1 if no module is installed
  *         -2 if it is out of sync and
  *          0 on success.
@@ -72,9 +123,31 @@ spearTimestampGetCurrent(SpearTimestamp *pres);
 SpearSmallTimestamp
 spearSmallTimestampGetCurrent();
 
+/* Register the TSSM as a generalTime current time and event
+ * provider (event n, 1..TSSM_INT_NUM, is the last interrupt from
+ * source n-1, see spearTimestampGetIoscan()). A thread pairs the
+ * timestamp with the time of the next provider every 'calPeriod'
+ * seconds (default 10) and fits the tick period in between.
+ * 'priority' <= 0 selects 90, ahead of NTP.
+ * Calling again only changes 'calPeriod'.
+ */
+int
+spearTimestampTimeConfigure(int priority, double calPeriod);
+
+/* convert a timestamp to wallclock time with the above model;
+ * no division, no VME access.
+ * RETURNS 0 on success, -1 if there is no valid model or 'ts' is
+ *         more than 2*calPeriod+1 seconds away from the last
+ *         calibration (e.g., the counter was reset or rolled over).
+ */
+int
+spearTimestampToEpicsTime(SpearTimestamp ts, epicsTimeStamp *pt);
+
 /* Set the processing time of a record
  * (NOTE: TSE must be set to epicsTimeEventDeviceTime (-2) )
  * - to be used by device support modules.
+ * After spearTimestampTimeConfigure() the time comes from
+ * spearTimestampToEpicsTime(). Otherwise
  * prec->time.sec is set to the current wallclock time
  * prec->time.nsec to the spear timestamp (modulo 1E9).
  * 
@@ -86,6 +159,11 @@ spearTimestampSetRecordTimeCurrent(dbCommon *prec);
 /* if tse == -2, set the processing time to 'now' (secs) / 'tstamp' (nsecs).
  * If the 'doAdjSecs' flag is set, the seconds are adjusted by the difference
  * of the current timestamp and 'tstamp'.
+ * After spearTimestampTimeConfigure() the time of 'tstamp' is used
+ * instead and 'doAdjSecs' only selects the return value.
+ *
+ * RETURNS: current timestamp if 'doAdjSecs' is set, SPEAR_TIMESTAMP_INVALID
+ *          otherwise
  */ 
 SpearTimestamp
 spearTimestampSetRecordTime(dbCommon *prec, SpearTimestamp tstamp, int doAdjSecs);
@@ -107,7 +185,8 @@ SpearEvents
 spearTimestampSetEvent(int num, int val);
 
 /* return spearTime modulo nsec/sec
- * TODO: what to do when spearTime rolls over??
+ * NOTE: this wraps every 1E9 ticks (~69 hours) and carries no
+ *       wallclock time; use spearTimestampToEpicsTime() for that.
  */
 #define spearTimestampToEpicsNsec(s) \
 	(SPEAR_TIMESTAMP_INVALID == s ? 1000000000 : ((epicsUInt32)(s % (SpearTimestamp)1000000000)))
@@ -116,6 +195,42 @@ spearTimestampSetEvent(int num, int val);
 unsigned long
 spearTimestampGetUsecSinceTick();
 
+/* Latency monitor; kept by the driver's ISR on every sync.
+ * LATENCY: delay from the sync to ISR entry (timer1), bin n is n us.
+ * JITTER:  deviation of the interval between ISR entries from the
+ *          tick period, bin n is n-SPEAR_TIMESTAMP_HIST_BINS/2 us.
+ * The first and last bins also hold everything beyond.
+ */
+#define SPEAR_TIMESTAMP_HIST_LATENCY	0
+#define SPEAR_TIMESTAMP_HIST_JITTER		1
+#define SPEAR_TIMESTAMP_HIST_NUM		2
+#define SPEAR_TIMESTAMP_HIST_BINS		64
+
+typedef struct SpearTimestampLatencyStats_ {
+	unsigned long	count;
+	double			mean, rms;	/* us */
+	long			min, max;	/* us */
+	unsigned long	missed;		/* intervals > 1.5 ticks, not in JITTER */
+} SpearTimestampLatencyStats;
+
+/* copy up to 'nelm' bins of histogram 'which'; RETURNS the number
+ * copied or -1 if 'which' is invalid. Bins are read on the fly, not
+ * as a consistent set.
+ */
+int
+spearTimestampGetHistogram(int which, epicsUInt32 *buf, int nelm);
+
+int
+spearTimestampGetLatencyStats(int which, SpearTimestampLatencyStats *p);
+
+/* the ISR clears the histograms on the next sync */
+void
+spearTimestampClearHistograms();
+
+/* print both histograms; clear them afterwards if 'clear' is set */
+int
+spearTimestampLatencyReport(int clear);
+
 /* for profiling/performance: read the TSSM timer1
  * with reference to the PPC timebase. I.e., 
  * you may fix the reference by
@@ -43,9 +43,15 @@
 #include <devSup.h>
 #include <aiRecord.h>
 #include <aoRecord.h>
+#include <int64inRecord.h>
+#include <waveformRecord.h>
+#include <dbFldTypes.h>
 #include <epicsExport.h>
 
 #include "drvSSI.h"
+#ifdef HAS_SPEAR_TIMESTAMP
+#include "drvSpearTimestamp.h"
+#endif
 
 
 struct ao_dev_sup {
@@ -153,6 +159,7 @@ struct ai_dev_sup {
 };
 
 STATIC long init_record_ai();
+STATIC long get_ioint_info_ai();
 STATIC long read_ai();
 STATIC long linconv_ai();
 
@@ -161,7 +168,7 @@ struct ai_dev_sup devSSI = {
 	NULL,
 	NULL,
 	init_record_ai,
-	NULL,
+	get_ioint_info_ai,
 	read_ai,
 	linconv_ai,/* linconv_ai,*/
 };
@@ -194,6 +201,8 @@ STATIC long init_record_ai(
 		return(S_db_badField);
   }
   if (strcmp(pvmeio->parm,"CALIB") && strcmp(pvmeio->parm,"RESET") &&
+      strcmp(pvmeio->parm,"VELO") && strcmp(pvmeio->parm,"ACCL") &&
+      strcmp(pvmeio->parm,"ABS") &&
       (strlen(pvmeio->parm) > 0)) {
 		recGblRecordError(S_db_badField, (void *) pai,
 			"devAiSSI (init_record) Invalid parameter in INP field");
@@ -216,6 +225,19 @@ STATIC long init_record_ai(
   return(0);
 }
 
+/* I/O Intr: processed by the poll thread when the channel moves (see SSIPollConfigure) */
+STATIC long get_ioint_info_ai(int cmd, struct aiRecord *pai, IOSCANPVT *ppvt)
+{
+  struct vmeio *pvmeio = (struct vmeio *) &(pai->inp.value);
+
+  if (SSIGetChanScan(pai->dpvt, pvmeio->signal, ppvt)) {
+    recGblRecordError(S_db_badField, (void *)pai,
+		      "devAiSSI (get_ioint_info) card is not polled");
+    return(S_db_badField);
+  }
+  return(0);
+}
+
 /*------------------------------------------------------------------------------------------*/
 /*------------------------------------------------------------------------------------------*/
 /*------------------------------------------------------------------------------------------*/
@@ -229,13 +251,54 @@ STATIC long read_ai(struct aiRecord *pai)
     struct vmeio *pvmeio;/*  = &pai->inp.value.vmeio; */
     int status;
     int iVal;
+    double dVal;
+    epicsInt64 lVal;
 
     pvmeio = (struct vmeio *)&(pai->inp.value);
+    if (pvmeio->parm[0] == 'A' && pvmeio->parm[1] == 'B') {
+      /* unwrapped position, converted like RVAL would be */
+      status = SSI_readPosition(pai->dpvt, pvmeio->signal, &lVal);
+      if (status) {
+	recGblSetSevr(pai, READ_ALARM, INVALID_ALARM);
+	return(2);
+      }
+      /* the 64 bit count does not fit RVAL; do what the record's
+         convert() does with ROFF, ASLO, AOFF, ESLO, EOFF and SMOO */
+      dVal = (double)lVal + (double)pai->roff;
+      if (pai->aslo != 0.0) dVal *= pai->aslo;
+      dVal += pai->aoff;
+      if (pai->linr) dVal = dVal * pai->eslo + pai->eoff;
+      if ((pai->smoo != 0.0) && !pai->init)
+        dVal = dVal * (1.0 - pai->smoo) + pai->val * pai->smoo;
+      pai->val = dVal;
+      pai->udf = 0;
+      if (pai->tse == epicsTimeEventDeviceTime)
+        SSIGetSnapTime(pai->dpvt, &pai->time);
+      return(2);
+    }
+    if ((pvmeio->parm[0] == 'V') || (pvmeio->parm[0] == 'A')) {
+      /* counts/sec and counts/sec/sec, in EGU by the position's slope */
+      status = SSI_readMotion(pai->dpvt, pvmeio->signal, pvmeio->parm, &dVal);
+      /* No estimate yet: leave UDF set, the record raises the UDF alarm */
+      if (status == S_drvSSI_noData) return(2);
+      if (status) {
+	recGblSetSevr(pai, READ_ALARM, INVALID_ALARM);
+	return(2);
+      }
+      if (pai->linr) dVal *= pai->eslo;
+      pai->val = dVal;
+      pai->udf = 0;
+      if (pai->tse == epicsTimeEventDeviceTime)
+        SSIGetSnapTime(pai->dpvt, &pai->time);
+      return(2);
+    }
     status = SSI_read(pai->dpvt, pvmeio->signal,pvmeio->parm,&iVal);
     if (status) {
 	recGblSetSevr(pai, READ_ALARM, INVALID_ALARM);
     } else {
       pai->rval = iVal;
+      if (pai->tse == epicsTimeEventDeviceTime)
+        SSIGetSnapTime(pai->dpvt, &pai->time);
     }
     return(0);
 }
@@ -255,3 +318,168 @@ STATIC long linconv_ai( struct aiRecord *pai, int after)
 }
  
 
+/*------------------------------------------------------------*/
+
+struct int64in_dev_sup {
+	long            number;
+	DEVSUPFUN       dev_report;
+	DEVSUPFUN       init;
+	DEVSUPFUN       init_record;
+	DEVSUPFUN       get_ioint_info;
+	DEVSUPFUN       read_int64in;
+};
+
+STATIC long init_record_int64in();
+STATIC long read_int64in();
+
+struct int64in_dev_sup devI64inSSI = {
+	5,
+	NULL,
+	NULL,
+	init_record_int64in,
+	NULL,
+	read_int64in
+};
+epicsExportAddress( dset, devI64inSSI);
+
+/* The unwrapped position in counts, INP "#C<card> S<chan> @" or "@ABS" */
+STATIC long init_record_int64in(struct int64inRecord *prec)
+{
+  struct vmeio *pvmeio = (struct vmeio *) &(prec->inp.value);
+
+  switch (prec->inp.type) {
+	case (VME_IO):
+		break;
+	default:
+		recGblRecordError(S_db_badField, (void *) prec,
+			"devI64inSSI (init_record) Illegal INP field");
+		return(S_db_badField);
+  }
+  if ((pvmeio->signal < 0) || (pvmeio->signal >= SSI_NUM_CHANNELS)) {
+		recGblRecordError(S_db_badField, (void *) prec,
+			"devI64inSSI (init_record) invalid signal number in INP field");
+		return(S_db_badField);
+  }
+  if (strcmp(pvmeio->parm,"ABS") && (strlen(pvmeio->parm) > 0)) {
+		recGblRecordError(S_db_badField, (void *) prec,
+			"devI64inSSI (init_record) Invalid parameter in INP field");
+		return(S_db_badField);
+  }
+  if (!(prec->dpvt = SSIGetCardPtr(pvmeio->card))) {
+                recGblRecordError(S_dev_badCard, (void *)prec,
+			"devI64inSSI (init_record) Invalid card number");
+                return(S_dev_badCard);
+  }
+  return(0);
+}
+
+STATIC long read_int64in(struct int64inRecord *prec)
+{
+    struct vmeio *pvmeio = (struct vmeio *)&(prec->inp.value);
+    epicsInt64 lVal;
+
+    if (SSI_readPosition(prec->dpvt, pvmeio->signal, &lVal)) {
+	recGblSetSevr(prec, READ_ALARM, INVALID_ALARM);
+    } else {
+      prec->val = lVal;
+      if (prec->tse == epicsTimeEventDeviceTime)
+        SSIGetSnapTime(prec->dpvt, &prec->time);
+    }
+    return(0);
+}
+
+/*------------------------------------------------------------*/
+
+struct wf_dev_sup {
+	long            number;
+	DEVSUPFUN       dev_report;
+	DEVSUPFUN       init;
+	DEVSUPFUN       init_record;
+	DEVSUPFUN       get_ioint_info;
+	DEVSUPFUN       read_wf;
+};
+
+STATIC long init_record_wf();
+STATIC long get_ioint_info_wf();
+STATIC long read_wf();
+
+struct wf_dev_sup devWfSSI = {
+	5,
+	NULL,
+	NULL,
+	init_record_wf,
+	get_ioint_info_wf,
+	read_wf
+};
+epicsExportAddress( dset, devWfSSI);
+
+/*
+ * The last block of positions captured on TSSM ticks (see
+ * SSICaptureConfigure), INP "#C<card> S<chan> @CAPT", or their
+ * SpearTimestamps, "@TIME". FTVL must be DOUBLE.
+ */
+STATIC long init_record_wf(struct waveformRecord *pwf)
+{
+  struct vmeio *pvmeio = (struct vmeio *) &(pwf->inp.value);
+  IOSCANPVT scan;
+
+  switch (pwf->inp.type) {
+	case (VME_IO):
+		break;
+	default:
+		recGblRecordError(S_db_badField, (void *) pwf,
+			"devWfSSI (init_record) Illegal INP field");
+		return(S_db_badField);
+  }
+  if ((pvmeio->signal < 0) || (pvmeio->signal >= SSI_NUM_CHANNELS)) {
+		recGblRecordError(S_db_badField, (void *) pwf,
+			"devWfSSI (init_record) invalid signal number in INP field");
+		return(S_db_badField);
+  }
+  if (strcmp(pvmeio->parm,"CAPT") && strcmp(pvmeio->parm,"TIME")) {
+		recGblRecordError(S_db_badField, (void *) pwf,
+			"devWfSSI (init_record) Invalid parameter in INP field");
+		return(S_db_badField);
+  }
+  if (pwf->ftvl != DBF_DOUBLE) {
+		recGblRecordError(S_db_badField, (void *) pwf,
+			"devWfSSI (init_record) FTVL must be DOUBLE");
+		return(S_db_badField);
+  }
+  if (!(pwf->dpvt = SSIGetCardPtr(pvmeio->card))) {
+                recGblRecordError(S_dev_badCard, (void *)pwf,
+			"devWfSSI (init_record) Invalid card number");
+                return(S_dev_badCard);
+  }
+  if (SSIGetCaptureScan(pwf->dpvt, &scan)) {
+                recGblRecordError(S_dev_badCard, (void *)pwf,
+			"devWfSSI (init_record) No capture configured on card");
+                return(S_dev_badCard);
+  }
+  return(0);
+}
+
+STATIC long get_ioint_info_wf(int cmd, struct waveformRecord *pwf, IOSCANPVT *ppvt)
+{
+  return (SSIGetCaptureScan(pwf->dpvt, ppvt) ? -1 : 0);
+}
+
+STATIC long read_wf(struct waveformRecord *pwf)
+{
+    struct vmeio *pvmeio = (struct vmeio *)&(pwf->inp.value);
+    epicsUInt64 first;
+    int count;
+
+    count = SSI_readCapture(pwf->dpvt, pvmeio->signal, pvmeio->parm,
+                            (double *)pwf->bptr, pwf->nelm, &first);
+    if (count < 0) {
+	recGblSetSevr(pwf, READ_ALARM, INVALID_ALARM);
+	return(0);
+    }
+    pwf->nord = count;
+#ifdef HAS_SPEAR_TIMESTAMP
+    if (count)
+      spearTimestampSetRecordTime((dbCommon *)pwf, first, 1);
+#endif
+    return(0);
+}
@@ -6,6 +6,7 @@
 
 /* SSI is an EPICS driver for the R. Kramert SSI board */
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #include <drvSup.h>
@@ -15,8 +16,16 @@
 #include <registryFunction.h>
 #include <iocsh.h>
 #include <epicsTypes.h>
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+#include <epicsAtomic.h>
+#include <dbScan.h>
 #include <epicsExport.h>
 #include "drvSSI.h"
+#ifdef HAS_SPEAR_TIMESTAMP
+#include "drvSpearTimestamp.h"
+#endif
 #ifdef HAS_IOOPS_H
 #include "basicIoOps.h"
 #define SSI_VME_REG16_READ(address) in_be16((volatile void*)(address))
@@ -42,6 +51,9 @@
 
 static int iDebug = SSI_NO_DEBUG;
 
+/* SSI_read reads the card again when its snapshot is older (sec) */
+double SSISnapAge = 0.005;
+
 /* SSI memory structure */
 
 typedef struct io_SSI_mem {
@@ -49,6 +61,25 @@ typedef struct io_SSI_mem {
   epicsUInt32 csr;
 } io_SSI_mem; 
 
+/* All channels of a card read in one pass, see SSI_snapshot */
+
+typedef struct io_SSI_snap {
+  epicsUInt32    iChan[SSI_NUM_CHANNELS]; /* as read, not masked by range */
+  epicsUInt32    csr;
+  epicsTimeStamp time;                    /* when the pass was made */
+  unsigned long  count;                   /* number of passes so far */
+} io_SSI_snap;
+
+/* Motion of a channel, estimated at every pass over the card */
+
+typedef struct io_SSI_motion {
+  epicsInt64     position;                /* counts, unwrapped across passes */
+  double         rawVelo;                 /* counts/sec over the last pass */
+  double         velocity;                /* counts/sec, filtered */
+  double         accel;                   /* counts/sec/sec, filtered */
+  unsigned long  samples;                 /* differences taken so far */
+} io_SSI_motion;
+
 /* structure that holds all neccessary addresses for SSI board */
 
 typedef struct io_SSI {
@@ -68,10 +99,40 @@ typedef struct io_SSI {
   int           iChan_oldMod[SSI_NUM_CHANNELS];
   int           piChanInUse[SSI_NUM_CHANNELS];
   epicsUInt32   piChanOffset[SSI_NUM_CHANNELS];
+  epicsMutexId  lock;                  /* guards snap and motion */
+  io_SSI_snap   snap;
+  io_SSI_motion motion[SSI_NUM_CHANNELS];
+  double        filter;                /* weight of a new estimate, 1 = none */
+  double        pollPeriod;            /* 0 => the records read the card */
+  epicsThreadId pollThread;
+
+  /* The poll thread processes a channel's I/O Intr records when it has
+   * moved more than deadband counts from the position last posted. */
+  IOSCANPVT     chanScan[SSI_NUM_CHANNELS];
+  epicsUInt32   deadband[SSI_NUM_CHANNELS];
+  epicsUInt32   iChan_posted[SSI_NUM_CHANNELS];
+  unsigned long posts;
+
+  /* Capture on TSSM ticks: the ISR fills one half of a ring of
+   * 2*capSamples samples while the records read the other half. */
+  int           capSamples;            /* per half, 0 => no capture */
+  int           capDecimate;           /* ticks per sample */
+  int           capTick;
+  int           capHead;               /* next sample in the ring */
+  volatile unsigned long capBlocks;    /* halves completed */
+  epicsUInt64   *pCapTime;             /* 2*capSamples SpearTimestamps */
+  epicsUInt32   *pCapData;             /* 2*capSamples*numChannels */
+  IOSCANPVT     capScan;
 } io_SSI;
 
 static long SSI_driver_init();
 static long SSI_io_report(int iReportLevel);
+static void SSI_readSnap(io_SSI *pCard);
+static void SSI_lockSnap(io_SSI *pCard);
+static void SSI_pollTask(void *parm);
+#ifdef HAS_SPEAR_TIMESTAMP
+static void SSI_tickIsr(void *arg, unsigned mask);
+#endif
 
 /*
  *	Driver entry table
@@ -148,6 +209,11 @@ int SSIConfigure(
         errlogPrintf ("%s: Memory allocation error\n", id_expected);
 	return -1;
     }
+    if ( (pCard->lock = epicsMutexCreate()) == NULL ) {
+        errlogPrintf ("%s: Cannot create lock for card %2d\n", id_expected, cardNum);
+        free (pCard);
+	return -1;
+    }
 
     pCard->configured      = epicsFalse; 
     pCard->range           = range;
@@ -157,14 +223,134 @@ int SSIConfigure(
     pCard->numChannels     = numChannels;
     pCard->numBits         = numBits;    
     pCard->dataFormat      = dataFormat;
-    for(iIndex=0;iIndex<SSI_NUM_CHANNELS;iIndex++)
+    pCard->filter          = 1.0;
+    for(iIndex=0;iIndex<SSI_NUM_CHANNELS;iIndex++) {
       pCard->iChan_oldMod[iIndex] = -1;
+      scanIoInit(&pCard->chanScan[iIndex]);
+    }
 
     /* add the card structure to the list of known event receiver cards.  */
     ellAdd (&ssiList, &pCard->Link);
     return 0;
 }
 
+/*--------------------------------------------------------------
+ *  SSI POLL CONFIGURE
+ *      read a configured card from a thread every period seconds,
+ *      which sets the rate velocity and acceleration are estimated at.
+ *      A new estimate is given weight filter (0 < filter <= 1) against
+ *      the old one.
+ */
+int SSIPollConfigure(
+    int         cardNum,        /* card number as used in INP fields */
+    double      period,         /* seconds between reads, 0 = no thread */
+    double      filter          /* 1 = no filtering */
+)
+{
+    io_SSI	*pCard;
+
+    if ((period < 0.0) || (filter <= 0.0) || (filter > 1.0)) {
+      errlogPrintf ("%s: card %2d invalid period %g or filter %g!\n",
+                    id_expected, cardNum, period, filter);
+      return -1;
+    }
+    for (pCard = ssiListInit ? (io_SSI *)ellFirst(&ssiList) : NULL;
+         pCard != NULL;
+         pCard = (io_SSI *)ellNext(&pCard->Link)) {
+      if (cardNum == pCard->cardNum) {
+        pCard->pollPeriod = period;
+        pCard->filter     = filter;
+        return 0;
+      }
+    }
+    errlogPrintf ("%s: card %2d not configured!\n", id_expected, cardNum);
+    return -1;
+}
+
+/*--------------------------------------------------------------
+ *  SSI DEADBAND CONFIGURE
+ *      counts a channel must move before the poll thread processes
+ *      its I/O Intr records; channel -1 sets every channel of the card.
+ */
+int SSIDeadbandConfigure(
+    int         cardNum,        /* card number as used in INP fields */
+    int         channel,        /* channel, -1 = all */
+    int         counts          /* 0 = any change */
+)
+{
+    io_SSI	*pCard;
+    int         iIndex;
+
+    for (pCard = ssiListInit ? (io_SSI *)ellFirst(&ssiList) : NULL;
+         pCard != NULL;
+         pCard = (io_SSI *)ellNext(&pCard->Link)) {
+      if (cardNum == pCard->cardNum) {
+        if ((channel < -1) || (channel >= pCard->numChannels) || (counts < 0)) {
+          errlogPrintf ("%s: card %2d invalid channel %d or deadband %d!\n",
+                        id_expected, cardNum, channel, counts);
+          return -1;
+        }
+        for(iIndex=0;iIndex<pCard->numChannels;iIndex++)
+          if ((channel == -1) || (channel == iIndex))
+            pCard->deadband[iIndex] = counts;
+        return 0;
+      }
+    }
+    errlogPrintf ("%s: card %2d not configured!\n", id_expected, cardNum);
+    return -1;
+}
+
+/*--------------------------------------------------------------
+ *  SSI CAPTURE CONFIGURE
+ *      latch all channels of a configured card on every decimate'th
+ *      TSSM tick and publish them samples at a time to waveforms.
+ */
+int SSICaptureConfigure(
+    int         cardNum,        /* card number as used in INP fields */
+    int         samples,        /* samples per waveform */
+    int         decimate        /* TSSM ticks per sample, 1 = every tick */
+)
+{
+#ifdef HAS_SPEAR_TIMESTAMP
+    io_SSI	*pCard;
+
+    if ((samples <= 0) || (decimate <= 0)) {
+      errlogPrintf ("%s: card %2d invalid # samples %d or decimation %d!\n",
+                    id_expected, cardNum, samples, decimate);
+      return -1;
+    }
+    for (pCard = ssiListInit ? (io_SSI *)ellFirst(&ssiList) : NULL;
+         pCard != NULL;
+         pCard = (io_SSI *)ellNext(&pCard->Link)) {
+      if (cardNum == pCard->cardNum) {
+        if (pCard->capSamples) {
+          errlogPrintf ("%s: card %2d capture already configured!\n",
+                        id_expected, cardNum);
+          return -1;
+        }
+        pCard->pCapTime = calloc (2*samples, sizeof(epicsUInt64));
+        pCard->pCapData = calloc (2*samples*pCard->numChannels, sizeof(epicsUInt32));
+        if (!pCard->pCapTime || !pCard->pCapData) {
+          errlogPrintf ("%s: Memory allocation error\n", id_expected);
+          free (pCard->pCapTime);
+          free (pCard->pCapData);
+          pCard->pCapTime = NULL;
+          pCard->pCapData = NULL;
+          return -1;
+        }
+        scanIoInit (&pCard->capScan);
+        pCard->capDecimate = decimate;
+        pCard->capSamples  = samples;
+        return 0;
+      }
+    }
+    errlogPrintf ("%s: card %2d not configured!\n", id_expected, cardNum);
+#else
+    errlogPrintf ("%s: built without TSSM support, no capture\n", id_expected);
+#endif
+    return -1;
+}
+
 /*--------------------------------------------------------------
 **  SSI Get Card Base Address
 **      Utility routine in case someone wants to know the card's base address.
@@ -224,8 +410,10 @@ static long SSI_driver_init()
     io_SSI	         *pCard;
     int 	       	 status;
     int                  iIndex;
+#ifdef HAS_SPEAR_TIMESTAMP
+    int                  capture = 0;
+#endif
     epicsUInt32          csr;
-    volatile epicsUInt32 *piChan_new;
 
 #ifdef DEBUG    
     printf("======= enter driver SSI\n");
@@ -276,14 +464,283 @@ static long SSI_driver_init()
 	pCard->configured = epicsTrue; /* this line only says that the given */
 	                               /* card was configured correctly */
 	/* Initialize the previous channel values. */
-        piChan_new = pCard->pSsiMem->iChan;
-        for(iIndex=0;iIndex<pCard->numChannels;iIndex++)
-          pCard->iChan_old[iIndex] = SSI_VME_REG32_READ(&(piChan_new[iIndex])) &
-                                     pCard->range;
+        SSI_readSnap(pCard);
+        for(iIndex=0;iIndex<pCard->numChannels;iIndex++) {
+          pCard->iChan_old[iIndex] = pCard->snap.iChan[iIndex] & pCard->range;
+          pCard->iChan_posted[iIndex] = pCard->iChan_old[iIndex];
+        }
+
+        if (pCard->pollPeriod > 0.0) {
+          char name[20];
+
+          sprintf(name, "SSIpoll%d", pCard->cardNum);
+          pCard->pollThread = epicsThreadCreate(name, epicsThreadPriorityHigh,
+                                                epicsThreadGetStackSize(epicsThreadStackSmall),
+                                                SSI_pollTask, pCard);
+          if (!pCard->pollThread)
+            errlogPrintf ("%s: Cannot start poll thread for card %d\n",
+                          id_expected, pCard->cardNum);
+        }
+#ifdef HAS_SPEAR_TIMESTAMP
+        if (pCard->capSamples) capture = 1;
+#endif
     }    
+#ifdef HAS_SPEAR_TIMESTAMP
+    if (capture &&
+        drvSpearTimestampConnectISR(SSI_tickIsr, NULL, TSSM_INT_SYNC)) {
+      errlogPrintf ("%s: Cannot connect to the TSSM tick, no capture\n",
+                    id_expected);
+    }
+#endif
     return 0;
 }
 
+/*-----------------------------------------------------------------------*/
+/*------------------------------ SSI snapshot ---------------------------*/
+/*-----------------------------------------------------------------------*/
+
+/* Signed counts from iOld to iNew, taking the shorter way round the range */
+static epicsInt64 SSI_delta(io_SSI *pCard, epicsUInt32 iOld, epicsUInt32 iNew)
+{
+   epicsUInt32 iDiff = (iNew - iOld) & pCard->range;
+
+   if (iDiff > pCard->range/2)
+     return (epicsInt64)iDiff - (epicsInt64)pCard->range - 1;
+   return (epicsInt64)iDiff;
+}
+
+/* Estimate velocity and acceleration from one more difference */
+static void SSI_motion(io_SSI *pCard, int iIndex, epicsInt64 iStep, double dt)
+{
+   io_SSI_motion *pMotion = &pCard->motion[iIndex];
+   double velo;
+   double accel;
+
+   velo = (double)iStep / dt;
+   if (pMotion->samples == 0) {
+     pMotion->velocity = velo;
+   } else {
+     accel = (velo - pMotion->rawVelo) / dt;
+     if (pMotion->samples == 1) pMotion->accel = accel;
+     else pMotion->accel += pCard->filter * (accel - pMotion->accel);
+     pMotion->velocity += pCard->filter * (velo - pMotion->velocity);
+   }
+   pMotion->rawVelo = velo;
+   pMotion->samples++;
+}
+
+/* Read every channel and the CSR in one pass; the caller holds the lock */
+static void SSI_readSnap(io_SSI *pCard)
+{
+   volatile epicsUInt32   *piChan_new = pCard->pSsiMem->iChan;
+   int iIndex;
+   epicsUInt32 iNew;
+   epicsInt64 iStep;
+   epicsTimeStamp now;
+   double dt;
+
+   epicsTimeGetCurrent(&now);
+   dt = pCard->snap.count ? epicsTimeDiffInSeconds(&now, &pCard->snap.time) : 0.0;
+   for(iIndex=0;iIndex<pCard->numChannels;iIndex++) {
+     iNew = SSI_VME_REG32_READ(&(piChan_new[iIndex]));
+     if (!pCard->snap.count) {
+       pCard->motion[iIndex].position = iNew & pCard->range;
+     } else {
+       iStep = SSI_delta(pCard, pCard->snap.iChan[iIndex], iNew);
+       pCard->motion[iIndex].position += iStep;
+       if (dt > 0.0) SSI_motion(pCard, iIndex, iStep, dt);
+     }
+     pCard->snap.iChan[iIndex] = iNew;
+   }
+   if (pCard->csrAvail)
+     pCard->snap.csr = SSI_VME_REG32_READ(&(pCard->pSsiMem->csr));
+   pCard->snap.time = now;
+   pCard->snap.count++;
+}
+
+/*
+ * Read the card every pollPeriod, records then never read it.
+ * Channels that moved past their deadband get their records processed.
+ */
+static void SSI_pollTask(void *parm)
+{
+   io_SSI   *pCard = (io_SSI *)parm;
+   epicsUInt32 moved;
+   epicsUInt32 iVal;
+   epicsInt64 iStep;
+   int iIndex;
+
+   for (;;) {
+     epicsMutexMustLock(pCard->lock);
+     SSI_readSnap(pCard);
+     for(iIndex=0,moved=0;iIndex<pCard->numChannels;iIndex++) {
+       iVal  = pCard->snap.iChan[iIndex] & pCard->range;
+       iStep = SSI_delta(pCard, pCard->iChan_posted[iIndex], iVal);
+       if ((iStep > (epicsInt64)pCard->deadband[iIndex]) ||
+           (-iStep > (epicsInt64)pCard->deadband[iIndex])) {
+         pCard->iChan_posted[iIndex] = iVal;
+         moved |= 1u << iIndex;
+       }
+     }
+     epicsMutexUnlock(pCard->lock);
+     for(iIndex=0;moved;iIndex++,moved>>=1) {
+       if (moved & 1) {
+         scanIoRequest(pCard->chanScan[iIndex]);
+         pCard->posts++;
+       }
+     }
+     epicsThreadSleep(pCard->pollPeriod);
+   }
+}
+
+/* I/O Intr list of a channel; only a polled card processes it */
+int SSIGetChanScan(void *cardPtr, unsigned short channel, IOSCANPVT *ppvt)
+{
+   io_SSI   *pCard = (io_SSI *)cardPtr;
+
+   if (!pCard) return (S_drvSSI_noDevice);
+   if ((channel >= pCard->numChannels) || (pCard->pollPeriod <= 0.0))
+     return (S_drvSSI_badParam);
+   *ppvt = pCard->chanScan[channel];
+   return(S_drvSSI_OK);
+}
+
+/* Take the lock, reading the card first if the snapshot is too old */
+static void SSI_lockSnap(io_SSI *pCard)
+{
+   epicsTimeStamp now;
+
+   epicsMutexMustLock(pCard->lock);
+   if (pCard->pollThread) return;
+   epicsTimeGetCurrent(&now);
+   if (!pCard->snap.count ||
+       epicsTimeDiffInSeconds(&now, &pCard->snap.time) > SSISnapAge)
+     SSI_readSnap(pCard);
+}
+
+/*
+ * Read the card now. Records processed after this up to SSISnapAge
+ * later all see the positions of this one pass.
+ */
+int SSI_snapshot(void *cardPtr)
+{
+   io_SSI   *pCard = (io_SSI *)cardPtr;
+
+   if (!pCard) return (S_drvSSI_noDevice);
+   epicsMutexMustLock(pCard->lock);
+   SSI_readSnap(pCard);
+   epicsMutexUnlock(pCard->lock);
+   return(S_drvSSI_OK);
+}
+
+/* When the positions SSI_read returns were read */
+int SSIGetSnapTime(void *cardPtr, epicsTimeStamp *pTime)
+{
+   io_SSI   *pCard = (io_SSI *)cardPtr;
+
+   if (!pCard) return (S_drvSSI_noDevice);
+   epicsMutexMustLock(pCard->lock);
+   *pTime = pCard->snap.time;
+   epicsMutexUnlock(pCard->lock);
+   return(S_drvSSI_OK);
+}
+
+/*-----------------------------------------------------------------------*/
+/*------------------------------ SSI capture ----------------------------*/
+/*-----------------------------------------------------------------------*/
+
+#ifdef HAS_SPEAR_TIMESTAMP
+/* On the TSSM tick, latch every capturing card; interrupt context */
+static void SSI_tickIsr(void *arg, unsigned mask)
+{
+   io_SSI   *pCard;
+   volatile epicsUInt32   *piChan_new;
+   epicsUInt32 *pData;
+   SpearTimestamp ts;
+   int iIndex;
+
+   if (!(mask & TSSM_INT_SYNC)) return;
+   spearTimestampGetCurrent(&ts);
+   for (pCard = (io_SSI *)ellFirst(&ssiList);
+        pCard != NULL;
+        pCard = (io_SSI *)ellNext(&pCard->Link)) {
+     if (!pCard->capSamples || !pCard->configured) continue;
+     if (++pCard->capTick < pCard->capDecimate) continue;
+     pCard->capTick = 0;
+
+     piChan_new = pCard->pSsiMem->iChan;
+     pData = pCard->pCapData + pCard->capHead*pCard->numChannels;
+     for(iIndex=0;iIndex<pCard->numChannels;iIndex++)
+       pData[iIndex] = SSI_VME_REG32_READ(&(piChan_new[iIndex]));
+     pCard->pCapTime[pCard->capHead] = ts;
+
+     if (++pCard->capHead == 2*pCard->capSamples) pCard->capHead = 0;
+     if (pCard->capHead % pCard->capSamples == 0) {
+       /* the half's samples are stored before it is published */
+       epicsAtomicWriteMemoryBarrier();
+       pCard->capBlocks++;
+       scanIoRequest(pCard->capScan);
+     }
+   }
+}
+#endif
+
+/* I/O Intr list of the capture waveforms, processed per completed half */
+int SSIGetCaptureScan(void *cardPtr, IOSCANPVT *ppvt)
+{
+   io_SSI   *pCard = (io_SSI *)cardPtr;
+
+   if (!pCard || !pCard->capSamples) return (S_drvSSI_noDevice);
+   *ppvt = pCard->capScan;
+   return(S_drvSSI_OK);
+}
+
+/*
+ * The last completed half of the capture ring of a channel:
+ * parm "CAPT" positions (counts, plus any CALIB offset) or
+ * parm "TIME" SpearTimestamps. *pFirst gets the timestamp of the
+ * first sample. Returns the number of samples or -1.
+ */
+int SSI_readCapture(
+    void *cardPtr,
+    unsigned short channel,
+    char  *parm,
+    double *pBuf,
+    int   nelm,
+    epicsUInt64 *pFirst
+)
+{
+   io_SSI   *pCard = (io_SSI *)cardPtr;
+   unsigned long blocks;
+   int first;
+   int iIndex;
+   int tries;
+
+   if (!pCard || !pCard->capSamples || (channel >= pCard->numChannels))
+     return -1;
+   if (nelm > pCard->capSamples) nelm = pCard->capSamples;
+   /* the ISR only comes back to this half after completing the other */
+   for (tries = 0; tries < 3; tries++) {
+     blocks = pCard->capBlocks;
+     epicsAtomicReadMemoryBarrier();
+     if (!blocks) return 0;
+     first  = (blocks & 1) ? 0 : pCard->capSamples;
+     if (parm[0] == 'T') {
+       for (iIndex=0;iIndex<nelm;iIndex++)
+         pBuf[iIndex] = (double)pCard->pCapTime[first+iIndex];
+     } else {
+       for (iIndex=0;iIndex<nelm;iIndex++)
+         pBuf[iIndex] = (double)(epicsInt32)(
+                        (pCard->pCapData[(first+iIndex)*pCard->numChannels+channel] &
+                         pCard->range) + pCard->piChanOffset[channel]);
+     }
+     *pFirst = pCard->pCapTime[first];
+     epicsAtomicReadMemoryBarrier();
+     if (blocks == pCard->capBlocks) return nelm;
+   }
+   return -1;
+}
+
 /*-----------------------------------------------------------------------*/
 /*------------------------------ SSI READ function ----------------------*/
 /*-----------------------------------------------------------------------*/
@@ -296,19 +753,19 @@ int SSI_read(
 )
 {
    io_SSI   *pCard = (io_SSI *)cardPtr;
-   volatile epicsUInt32   *piChan_new;
    int iIndex;
    epicsUInt32 itmp;
    epicsUInt32 iVal;
 
    if (!pCard) return (S_drvSSI_noDevice);
-   piChan_new = pCard->pSsiMem->iChan;
+   if (channel >= pCard->numChannels) return (S_drvSSI_badParam);
+   SSI_lockSnap(pCard);
 
 /*-------- this region below prints the debug information --------*/
 
  if((iDebug != SSI_NO_DEBUG) && (iDebug != SSI_DEBUG_MY_CHANG)){
    for(iIndex=0;iIndex<pCard->numChannels;iIndex++){
-     iVal = SSI_VME_REG32_READ(&(piChan_new[iIndex])) & pCard->range;
+     iVal = pCard->snap.iChan[iIndex] & pCard->range;
      if( iVal > pCard->iChan_old[iIndex] ) itmp = iVal - pCard->iChan_old[iIndex];
      else itmp = pCard->iChan_old[iIndex] - iVal;
 			  
@@ -320,7 +777,7 @@ int SSI_read(
    printf("\n");
  }
 /*----------------------- end of debug ---------------------------*/
-   iVal = SSI_VME_REG32_READ(&(piChan_new[channel])) & pCard->range;
+   iVal = pCard->snap.iChan[channel] & pCard->range;
    *val = (int)iVal;
    if(iDebug == SSI_DEBUG_MY_CHANG) printf("\t0ld=0x%x\toldMod=0x%x\tN=0x%x\tNMod=0x%x\n",
 					   pCard->iChan_old[channel],
@@ -335,10 +792,63 @@ int SSI_read(
    *val =  *val + pCard->piChanOffset[channel];
 
    pCard->piChanInUse[channel] = 1;
+   epicsMutexUnlock(pCard->lock);
 
     return(S_drvSSI_OK);
 }
 
+/*
+ * Velocity (parm "VELO") or acceleration ("ACCL") of a channel in
+ * counts/sec and counts/sec/sec, as of the last pass over the card.
+ * S_drvSSI_noData until the card has been read often enough for one.
+ */
+int SSI_readMotion(
+    void *cardPtr,
+    unsigned short channel,
+    char  *parm,
+    double *val
+)
+{
+   io_SSI   *pCard = (io_SSI *)cardPtr;
+   io_SSI_motion *pMotion;
+   int status = S_drvSSI_OK;
+
+   if (!pCard) return (S_drvSSI_noDevice);
+   if (channel >= pCard->numChannels) return (S_drvSSI_badParam);
+   SSI_lockSnap(pCard);
+   pMotion = &pCard->motion[channel];
+   if (parm[0] == 'V') {
+     if (pMotion->samples < 1) status = S_drvSSI_noData;
+     *val = pMotion->velocity;
+   } else {
+     if (pMotion->samples < 2) status = S_drvSSI_noData;
+     *val = pMotion->accel;
+   }
+   epicsMutexUnlock(pCard->lock);
+   return(status);
+}
+
+/*
+ * Position of a channel unwrapped across counter rollover since driver
+ * init, plus any CALIB offset. Correct as long as no channel moves half
+ * the range between passes, so poll the card often enough for the axis.
+ */
+int SSI_readPosition(
+    void *cardPtr,
+    unsigned short channel,
+    epicsInt64 *val
+)
+{
+   io_SSI   *pCard = (io_SSI *)cardPtr;
+
+   if (!pCard) return (S_drvSSI_noDevice);
+   if (channel >= pCard->numChannels) return (S_drvSSI_badParam);
+   SSI_lockSnap(pCard);
+   *val = pCard->motion[channel].position + (epicsInt32)pCard->piChanOffset[channel];
+   epicsMutexUnlock(pCard->lock);
+   return(S_drvSSI_OK);
+}
+
 /*-----------------------------------------------------------------------*/
 /*------------------------------ SSI WRITE function ---------------------*/
 /*-----------------------------------------------------------------------*/
@@ -389,6 +899,16 @@ static long SSI_io_report(int iReportLevel)
     printf("VME     base   addr   0x%08X\n", pCard->base);
     printf("A24/D32 mapped addr   %p \n"   , pCard->pSsiMem);
     printf("Channel Max Value     0x%08X\n", pCard->range);
+    printf("Snapshots             %lu\n", pCard->snap.count);
+    if (pCard->capSamples)
+      printf("Capture               %d samples every %d ticks, %lu done\n",
+             pCard->capSamples, pCard->capDecimate, pCard->capBlocks);
+    if (pCard->pollThread) {
+      printf("Polled every          %g sec, filter %g, up to %g counts/sec\n",
+             pCard->pollPeriod, pCard->filter,
+             (double)(pCard->range/2) / pCard->pollPeriod);
+      printf("Moves posted          %lu\n", pCard->posts);
+    }
     if(iReportLevel == 1){
       if (pCard->csrAvail) printf("SSI CSR 0x%08X\n",
              SSI_VME_REG32_READ(&(pCard->pSsiMem->csr)));
@@ -437,7 +957,43 @@ static void SSIConfigureCall(const iocshArgBuf * args) {
                args[4].ival, args[5].ival);
 }
 
+static const iocshArg        SSIPollConfigureArg0    = {"Card Number"     , iocshArgInt};
+static const iocshArg        SSIPollConfigureArg1    = {"Period"          , iocshArgDouble};
+static const iocshArg        SSIPollConfigureArg2    = {"Filter"          , iocshArgDouble};
+static const iocshArg *const SSIPollConfigureArgs[3] = {&SSIPollConfigureArg0,
+                                                        &SSIPollConfigureArg1,
+                                                        &SSIPollConfigureArg2};
+static const iocshFuncDef    SSIPollConfigureDef     = {"SSIPollConfigure", 3, SSIPollConfigureArgs};
+static void SSIPollConfigureCall(const iocshArgBuf * args) {
+  SSIPollConfigure(args[0].ival, args[1].dval, args[2].dval);
+}
+
+static const iocshArg        SSIDeadbandConfigureArg0    = {"Card Number"     , iocshArgInt};
+static const iocshArg        SSIDeadbandConfigureArg1    = {"Channel"         , iocshArgInt};
+static const iocshArg        SSIDeadbandConfigureArg2    = {"Counts"          , iocshArgInt};
+static const iocshArg *const SSIDeadbandConfigureArgs[3] = {&SSIDeadbandConfigureArg0,
+                                                            &SSIDeadbandConfigureArg1,
+                                                            &SSIDeadbandConfigureArg2};
+static const iocshFuncDef    SSIDeadbandConfigureDef     = {"SSIDeadbandConfigure", 3, SSIDeadbandConfigureArgs};
+static void SSIDeadbandConfigureCall(const iocshArgBuf * args) {
+  SSIDeadbandConfigure(args[0].ival, args[1].ival, args[2].ival);
+}
+
+static const iocshArg        SSICaptureConfigureArg0    = {"Card Number"     , iocshArgInt};
+static const iocshArg        SSICaptureConfigureArg1    = {"Samples"         , iocshArgInt};
+static const iocshArg        SSICaptureConfigureArg2    = {"Decimate"        , iocshArgInt};
+static const iocshArg *const SSICaptureConfigureArgs[3] = {&SSICaptureConfigureArg0,
+                                                           &SSICaptureConfigureArg1,
+                                                           &SSICaptureConfigureArg2};
+static const iocshFuncDef    SSICaptureConfigureDef     = {"SSICaptureConfigure", 3, SSICaptureConfigureArgs};
+static void SSICaptureConfigureCall(const iocshArgBuf * args) {
+  SSICaptureConfigure(args[0].ival, args[1].ival, args[2].ival);
+}
+
 static void drvSSIRegister() {
     iocshRegister(&SSIConfigureDef, SSIConfigureCall );
+    iocshRegister(&SSIPollConfigureDef, SSIPollConfigureCall );
+    iocshRegister(&SSIDeadbandConfigureDef, SSIDeadbandConfigureCall );
+    iocshRegister(&SSICaptureConfigureDef, SSICaptureConfigureCall );
 }
 epicsExportRegistrar(drvSSIRegister);
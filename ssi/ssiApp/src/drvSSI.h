@@ -30,6 +30,9 @@
 
 
 
+#include <epicsTime.h>
+#include <dbScan.h>
+
 #define Ok 0
 #define ERR -1
 #define EOS '\0'
@@ -42,6 +45,8 @@
 
 void *SSIGetCardPtr(int cardNum);
 unsigned int SSIGetCardRange (void *cardPtr);
+int SSI_snapshot(void *cardPtr);
+int SSIGetSnapTime(void *cardPtr, epicsTimeStamp *pTime);
 
 int SSI_read(
         void *cardPtr,
@@ -50,6 +55,31 @@ int SSI_read(
         int   *val
 );
 
+int SSI_readMotion(
+        void *cardPtr,
+        unsigned short channel,
+	char  *parm,
+        double *val
+);
+
+int SSI_readPosition(
+        void *cardPtr,
+        unsigned short channel,
+        epicsInt64 *val
+);
+
+int SSIGetChanScan(void *cardPtr, unsigned short channel, IOSCANPVT *ppvt);
+int SSIGetCaptureScan(void *cardPtr, IOSCANPVT *ppvt);
+
+int SSI_readCapture(
+        void *cardPtr,
+        unsigned short channel,
+	char  *parm,
+        double *pBuf,
+        int   nelm,
+        epicsUInt64 *pFirst
+);
+
 int SSI_write(
         void *cardPtr,
         unsigned short channel,
@@ -73,3 +103,4 @@ int SSI_write(
 #define S_drvSSI_invSigMode drvSSIError(4)/*SSI driver: signal mode conflicts with device config*/
 #define S_drvSSI_cbackChg drvSSIError(5) /*SSI driver: specified callback differs from previous config*/
 #define S_drvSSI_alreadyQd drvSSIError(6)/*SSI driver: a read request is already queued for the channel*/
+#define S_drvSSI_noData drvSSIError(7) /*SSI driver: not enough passes over the card yet*/
@@ -27,6 +27,8 @@ extern "C" {
 #if (EPICS_VERSION >= 3 && EPICS_REVISION >= 14) || (EPICS_VERSION >= 7)
 
 #include <epicsMutex.h>
+#include <epicsEvent.h>
+#include <epicsTime.h>
 #include <epicsThread.h>
 #include <epicsString.h>
 #include <epicsInterrupt.h>
@@ -111,6 +113,19 @@ typedef volatile struct  {
 	unsigned long	padding[3];
 } VSAMMEM;
 
+/*
+ * Copy of the card memory taken in one pass (see VSAM_snapshot).
+ * Range and AC are kept as read, four and two channels per long.
+ */
+typedef struct VSAMSNAP {
+	float		data[VSAM_NUM_CHANS];
+	unsigned long	range[VSAM_NUM_CHANS/4];
+	unsigned long	ac[VSAM_NUM_CHANS/2];
+	unsigned long	status;
+	epicsTimeStamp	time;		/* when it was read */
+	unsigned long	count;		/* number of passes so far */
+} VSAMSNAP;
+
 typedef ELLLIST VSAM_CARD_LIST;
 
 typedef struct VSAMCNFG {
@@ -129,6 +144,16 @@ typedef struct VSAMCNFG {
    * only channel 0 is read and that information save here for later use.
    */
   float           fw_version[VSAM_NUM_CHANS]; 
+  epicsMutexId    lock;          /* guards snap */
+  VSAMSNAP        snap;          /* all ai records read from here */
+  IOSCANPVT       ioscan;        /* posted by VSAM_snapshot() and the poll thread */
+  double          period;        /* poll thread period (sec), 0: no thread */
+  double          fast_period;   /* the same while the card is in fast scan mode */
+  epicsThreadId   poll_tid;
+  unsigned long   polls;         /* passes by the poll thread */
+  unsigned long   posts;         /* of which something had changed */
+  epicsEventId    init_done;     /* signalled by the init thread */
+  int             init_status;   /* what VSAM_init() returned there */
 } VSAMCNFG;
 
 typedef struct  VSAMCNFG * VSAM_ID;
@@ -146,6 +171,9 @@ int  VSAM_config( short card, unsigned long addr );
 int  VSAM_present( short card,VSAMMEM *pVSAM );
 int  VSAM_get_adrs( short card,VSAMMEM **ppVSAM );
 int  VSAM_version( short card,unsigned short *pversion );
+int  VSAM_snapshot( short card );
+int  VSAM_get_ioscan( short card, IOSCANPVT *ppvt );
+int  VSAM_poll_config( short card, double period, double fast_period );
 
 int bo_VSAM_read(
      short		card,
@@ -165,6 +193,10 @@ int  translateVSAMChannel(
      char		spec,
      VSAMPVT		*ppvt);
 
+VSAMPVT *VSAM_get_pvt(
+     short		channel,
+     char		spec);
+
 int ai_VSAM_read(
      short		card,
      short		channel,
@@ -173,8 +205,15 @@ int ai_VSAM_read(
      float		*prval
                );
 
+int wf_VSAM_read(
+     short		card,
+     char		type,
+     float		*pbuf,
+     int		nelm
+               );
+
 int getVSAMRange(
-    VSAMMEM		*pMem,
+    VSAMSNAP		*pSnap,
     VSAMPVT		*ppvt,
     float		*pval
                 );
@@ -26,6 +26,7 @@
 /* Local prototypes */
 static long init_record(struct aiRecord *pai);
 static long read_ai(struct aiRecord *pai);
+static long get_ioint_info(int cmd, struct aiRecord *pai, IOSCANPVT *ppvt);
 static long special_linconv(struct aiRecord *pai, int after);
 static void aiVSAMconvert(struct aiRecord  *pai, float rval);
 
@@ -43,7 +44,7 @@ struct {
 	NULL,
 	NULL,
 	init_record,
-	NULL,
+	get_ioint_info,
 	read_ai,
 	special_linconv};
 
@@ -59,7 +60,7 @@ struct {
 	NULL,
 	NULL,
 	init_record,
-	NULL,
+	get_ioint_info,
 	read_ai};
 
 epicsExportAddress(dset, devAiSIAM);
@@ -77,7 +78,6 @@ static long init_record(struct aiRecord	*pai)
         static char *badField_c = "devAiVSAM (init_record) Illegal INP field";
         static char *badSig_c = "devAiVSAM (init_record) invalid ai sig field";
         static char *badType_c ="devAiVSAM (init_record) bad type,card,sig or parm field";
-        static char *memErr_c = "devAiVSAM (init_record) out of memory";
 
 
 	/* ai.inp must be a VME_IO */
@@ -99,16 +99,14 @@ static long init_record(struct aiRecord	*pai)
 	     }
              /* Is the channel valid? */
              else if (checkVSAMAi(chan) == OK) {
-               /* Setup the private device information */
-               ppvt = malloc(sizeof(VSAMPVT));
-	       if ((ppvt != NULL) && 
-		   (translateVSAMChannel(chan,spec,ppvt)==OK)) {
+               /* The private device information is the driver's, shared */
+               ppvt = VSAM_get_pvt(chan,spec);
+	       if (ppvt != NULL) {
 	         pai->dpvt = ppvt;
                  status = OK;
 	       }
                else {
-                 status =  S_dev_noMemory;
-	         recGblRecordError(status,(void *)pai,memErr_c );
+	         recGblRecordError(status,(void *)pai,badSig_c );
 	       }
 	     }
              else 
@@ -125,6 +123,15 @@ static long init_record(struct aiRecord	*pai)
 }
 
 
+/* All ai records of a card share its snapshot's scan list */
+static long get_ioint_info(int cmd, struct aiRecord *pai, IOSCANPVT *ppvt)
+{
+	struct vmeio *pvmeio = (struct vmeio *)&(pai->inp.value);
+
+	if (VSAM_get_ioscan(pvmeio->card, ppvt) != OK) return(ERROR);
+	return(OK);
+}
+
 static long read_ai(struct aiRecord  *pai)
 {
 	float         value;
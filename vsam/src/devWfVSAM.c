@@ -0,0 +1,138 @@
+/* devWfVSAM.c - Device Support Routines for VSAM waveforms
+ *
+ *      One record reads a value for every channel of a card:
+ *
+ *          INP  #C<card> S0 @D     analog data
+ *          INP  #C<card> S0 @R     channel ranges (volts)
+ *          INP  #C<card> S0 @A     AC peak-to-peak (volts)
+ *
+ *      FTVL is FLOAT or DOUBLE; NELM up to 32. The values all
+ *      come from one pass over the card (see VSAM_snapshot).
+ */
+#include        "epicsVersion.h"
+#include	<string.h>
+#include	<stdlib.h>
+
+#include	<alarm.h>
+#include	<dbDefs.h>
+#include	<dbAccess.h>
+#include	<dbFldTypes.h>
+#include	<recSup.h>
+#include	<devSup.h>
+#include        <recGbl.h>
+#include        "errlog.h"
+#include	<link.h>
+#include	<waveformRecord.h>
+#include	"VSAM.h"
+#include        <epicsExport.h>
+
+/* Local prototypes */
+static long init_record(struct waveformRecord *pwf);
+static long get_ioint_info(int cmd, struct waveformRecord *pwf, IOSCANPVT *ppvt);
+static long read_wf(struct waveformRecord *pwf);
+
+/* Global variables */
+struct {
+	long		number;
+	DEVSUPFUN	report;
+	DEVSUPFUN	init;
+	DEVSUPFUN	init_record;
+	DEVSUPFUN	get_ioint_info;
+	DEVSUPFUN	read_wf;
+} devWfVSAM={
+	5,
+	NULL,
+	NULL,
+	init_record,
+	get_ioint_info,
+	read_wf};
+
+epicsExportAddress(dset, devWfVSAM);
+
+static long init_record(struct waveformRecord *pwf)
+{
+	struct vmeio   *pvmeio;
+        long            status = S_db_badField;
+        long            iss;
+	char            spec;
+        static char *badField_c = "devWfVSAM (init_record) Illegal INP field";
+        static char *badType_c ="devWfVSAM (init_record) bad type,card or parm field";
+        static char *badFtvl_c ="devWfVSAM (init_record) FTVL must be FLOAT or DOUBLE";
+
+
+	/* wf.inp must be a VME_IO */
+	switch (pwf->inp.type) {
+	   case VME_IO:
+      	     pvmeio = (struct vmeio *)&(pwf->inp.value);
+	     spec = pvmeio->parm[0] ? pvmeio->parm[0] : DATA_TYPE;
+	     if ((pwf->ftvl != DBF_FLOAT) && (pwf->ftvl != DBF_DOUBLE)) {
+	       recGblRecordError(status,(void *)pwf,badFtvl_c);
+	       break;
+	     }
+	     if ((spec != DATA_TYPE) && (spec != RANGE_TYPE) && (spec != AC_TYPE)) {
+	       recGblRecordError(status,(void *)pwf,badType_c);
+	       break;
+	     }
+             /* Verify that the card is present */
+	     iss = verifyVSAM(pvmeio->card,0,spec);
+             if (iss < 0)
+	       recGblRecordError(status,(void *)pwf,badType_c );
+	     else
+               status = OK;	/* read_wf finds out if the card is absent */
+	     break;
+
+	   default :
+                status = S_db_badField;
+		recGblRecordError(status,(void *)pwf,badField_c);
+	}
+
+	return(status);
+}
+
+
+/* Shares the I/O Intr scan list of the card's ai records */
+static long get_ioint_info(int cmd, struct waveformRecord *pwf, IOSCANPVT *ppvt)
+{
+	struct vmeio *pvmeio = (struct vmeio *)&(pwf->inp.value);
+
+	if (VSAM_get_ioscan(pvmeio->card, ppvt) != OK) return(ERROR);
+	return(OK);
+}
+
+static long read_wf(struct waveformRecord *pwf)
+{
+	float         value[VSAM_NUM_CHANS];
+	double       *pdbl;
+	struct vmeio *pvmeio;
+	char          spec;
+	int           nelm;
+	int           i;
+	long          status;
+
+
+	pvmeio = (struct vmeio *)&(pwf->inp.value);
+	spec = pvmeio->parm[0] ? pvmeio->parm[0] : DATA_TYPE;
+	nelm = (pwf->nelm < VSAM_NUM_CHANS) ? (int)pwf->nelm : VSAM_NUM_CHANS;
+	status = wf_VSAM_read(pvmeio->card, spec, value, nelm);
+	if(status==-1) {
+	   if ( recGblSetSevr(pwf,READ_ALARM,INVALID_ALARM) &&
+                errVerbose  &&
+                (pwf->stat!=READ_ALARM ||pwf->sevr!=INVALID_ALARM))
+	      recGblRecordError(-1,(void *)pwf,"wf_VSAM_read Error");
+	   return(status);
+	}
+        else if(status==-2) {
+	   status=OK;
+	   recGblSetSevr(pwf,HW_LIMIT_ALARM,INVALID_ALARM);
+	}
+	if(status!=OK) return(status);
+
+	if (pwf->ftvl == DBF_FLOAT)
+	   memcpy(pwf->bptr, value, nelm*sizeof(float));
+	else {
+	   pdbl = (double *)pwf->bptr;
+	   for (i=0; i<nelm; i++) pdbl[i] = value[i];
+	}
+	pwf->nord = nelm;
+	return(OK);
+}
@@ -22,18 +22,25 @@ static char *cardFound_c = "VSAM Card %hd found at (A24) address 0x%8.8lx\n";
 static char *cardNotFound_c   = "verifyVSAM: card %hd not found\n";
 static char *chanOutOfRange   = "verifyVSAM: chan limit %d but chan %d\n";
 static char *invParam_c       = "verifyVSAM: unknown param char %c\n";
-static char *invRange_c       = "translateVSAMChannel: can't allocate range struct\n";
 
 
 
 /* Global varaibles */
 int     VSAM_DRV_DEBUG = 0;
+double  VSAM_SNAP_AGE  = 0.05;  /* ai reads re-read the card when the snapshot is older (sec) */
 
 /* Local variables */
 static VSAM_CARD_LIST  VSAM_card_list;
 static short           card_list_inited = 0;
 static short           ai_cards_found   = 0;
 
+/* Where each channel's data, range and AC sit in the card, the same */
+/* for every card; records point their dpvt here (VSAM_get_pvt).     */
+#define VSAM_PVT_DATA   0
+#define VSAM_PVT_RANGE  1
+#define VSAM_PVT_AC     2
+static VSAMPVT         VSAM_pvt_table[3][VSAM_NUM_CHANS+4];
+
 
 /* local function prototypes */
 static long    init();
@@ -42,6 +49,11 @@ static int     VSAM_clear( VSAMMEM *pVSAM );
 static int     VSAM_calibrateCheck( VSAMMEM *pMem );
 static VSAM_ID VSAM_getByCard( short  card );
 static VSAM_ID VSAM_getByAddr( unsigned long baseAddr );
+static int     VSAM_readSnap( VSAM_ID pcard );
+static void    VSAM_lockSnap( VSAM_ID pcard );
+static void    VSAM_pollTask( void *parg );
+static void    VSAM_initTask( void *parg );
+static int     VSAM_pvtRow( char spec );
 
 /* Global variables        */
 /* VSAM driver entry table */
@@ -60,18 +72,48 @@ static long init()
 {
     int        status=OK;
     VSAM_ID    pcard = NULL;
+    char       name_c[20];
  
 
     if( !card_list_inited )  return(OK);
 
+    /*
+     * VSAM_init() spends seconds per card waiting on the card,
+     * so bring all the cards up at once, each in a thread of
+     * its own, and then wait for the lot.
+     */
+    for( pcard=(VSAM_ID)ellFirst((ELLLIST *)&VSAM_card_list); pcard; pcard = (VSAM_ID)ellNext((ELLNODE *)pcard)) 
+    {
+       pcard->init_done = epicsEventCreate(epicsEventEmpty);
+       sprintf(name_c,"VSAMinit-%.2hd",pcard->card);
+       if ( !pcard->init_done ||
+            !epicsThreadCreate(name_c, epicsThreadPriorityMedium,
+                               epicsThreadGetStackSize(epicsThreadStackMedium),
+                               VSAM_initTask, pcard) ) 
+          VSAM_initTask( pcard );
+    }
+
     for( pcard=(VSAM_ID)ellFirst((ELLLIST *)&VSAM_card_list); pcard; pcard = (VSAM_ID)ellNext((ELLNODE *)pcard)) 
     {
-       status = VSAM_init( pcard );
+       if ( pcard->init_done ) {
+          epicsEventMustWait( pcard->init_done );
+          epicsEventDestroy( pcard->init_done );
+          pcard->init_done = NULL;
+       }
+       status = pcard->init_status;
        if ( status==OK )  {
 	  pcard->present = 1;
           if (VSAM_DRV_DEBUG) 
              printf( "VSAM: card %d initialized successfully at %p (A24)\n\n", pcard->card,pcard->pVSAM );
           ai_cards_found++;
+          if ( pcard->period > 0.0 ) {
+            sprintf(name_c,"VSAM-%.2hd",pcard->card);
+            pcard->poll_tid = epicsThreadCreate(name_c, epicsThreadPriorityMedium,
+                                                epicsThreadGetStackSize(epicsThreadStackSmall),
+                                                VSAM_pollTask, pcard);
+            if ( !pcard->poll_tid )
+              printf( "DRVSUP: VSAM card %d can't start poll thread\n", pcard->card);
+          }
        }
        else {
           printf( "DRVSUP: VSAM card %d found, initialization failed\n", pcard->card);
@@ -81,6 +123,15 @@ static long init()
     return( status );
 }
 
+static void VSAM_initTask( void *parg )
+{
+    VSAM_ID  pcard = (VSAM_ID)parg;
+
+    pcard->init_status = VSAM_init( pcard );
+    if ( pcard->init_done )
+       epicsEventSignal( pcard->init_done );
+}
+
 
 /***************************************************************************************************************************/
 /*  Routine: VSAM_config                                                                                                   */
@@ -105,6 +156,7 @@ int VSAM_config( short card, unsigned long addr)
     unsigned long     ioBase = 0;
     epicsAddressType  space = atVMEA24;   /* A24/D32 address space */
     char              name_c[40];
+    short             chan;
     VSAM_ID           pcard = NULL;
 
 
@@ -112,6 +164,10 @@ int VSAM_config( short card, unsigned long addr)
     {
         /* Initialize linked list */
         ellInit( (ELLLIST *) &VSAM_card_list);
+        for ( chan=0; chan<VSAM_NUM_CHANS+4; chan++ ) {
+          translateVSAMChannel(chan, DATA_TYPE, &VSAM_pvt_table[VSAM_PVT_DATA][chan]);
+          translateVSAMChannel(chan, AC_TYPE, &VSAM_pvt_table[VSAM_PVT_AC][chan]);
+        }
         card_list_inited = 1;
         if(VSAM_DRV_DEBUG) 
           printf("The size of VSAM Memory Map is %d\n", (int)sizeof(VSAMMEM));
@@ -137,6 +193,8 @@ int VSAM_config( short card, unsigned long addr)
     {
       pcard->card       = card;
       pcard->bus_addr   = addr;
+      pcard->lock       = epicsMutexMustCreate();
+      scanIoInit(&pcard->ioscan);
       ellAdd( (ELLLIST *)&VSAM_card_list, (ELLNODE *)pcard);
       pcard->registered = 1;
       status = OK;
@@ -505,10 +563,29 @@ int getVSAMBitMask( short          channel,
     return(0);
 }
 
+static int VSAM_pvtRow( char spec )
+{
+    if (spec == RANGE_TYPE) return(VSAM_PVT_RANGE);
+    if (spec == AC_TYPE)    return(VSAM_PVT_AC);
+    return(VSAM_PVT_DATA);
+}
+
+/*
+ * VSAM_get_pvt - the translated channel (see translateVSAMChannel)
+ *                out of the driver's table, NULL if out of range.
+ */
+VSAMPVT *VSAM_get_pvt( short channel, char spec )
+{
+    if ( !card_list_inited || channel < 0 || channel >= VSAM_NUM_CHANS+4 )
+      return(NULL);
+    return(&VSAM_pvt_table[VSAM_pvtRow(spec)][channel]);
+}
+
 /*
  * translateVSAMChannel - get address of 4-byte location containing ch's data.
  *
  * VSAM is D32 only, so byte and two-byte items must be extracted from longs.
+ * The range of an AC channel is the driver's table entry.
  */
 int translateVSAMChannel(short    channel,
                          char	  spec,
@@ -517,6 +594,7 @@ int translateVSAMChannel(short    channel,
     short     rem;
     VSAMPVT  *rpvt = NULL;
 
+    if ( channel < 0 || channel >= VSAM_NUM_CHANS+4 ) return(-2);
     switch ((int)spec) {
 	case RANGE_TYPE:
 	    rem = channel%4;
@@ -527,11 +605,7 @@ int translateVSAMChannel(short    channel,
 	    break;
 
 	case AC_TYPE:
-	    rpvt = malloc(sizeof(VSAMPVT));
-	    if (rpvt == NULL) {
-	        if (VSAM_DRV_DEBUG) printf( invRange_c );
-		return -2;
-	    }
+	    rpvt = &VSAM_pvt_table[VSAM_PVT_RANGE][channel];
 	    translateVSAMChannel(channel, RANGE_TYPE, rpvt);
 	    ppvt->prange = rpvt;
 	    rem = channel%2;
@@ -553,11 +627,149 @@ int translateVSAMChannel(short    channel,
 
 /* Input and Output routines */
 
+/*
+ * VSAM_readSnap - copy the data, range and AC blocks and the
+ *                 status register into the card's snapshot.
+ *
+ * One pass of D32 reads; the caller holds pcard->lock.
+ * Returns non-zero if anything differs from the last pass.
+ */
+static int VSAM_readSnap( VSAM_ID pcard )
+{
+    int                i;
+    int                changed = (pcard->snap.count == 0);
+    unsigned long      lval;
+    VSAMMEM           *pVSAM = pcard->pVSAM;
+    VSAMSNAP          *pSnap = &pcard->snap;
+    volatile uint32_t *ptr   = NULL;
+    union { uint32_t l; float f; } word;
+
+    for (i=0,ptr=(volatile uint32_t *)pVSAM->data; i<VSAM_NUM_CHANS; i++,ptr++) {
+      word.f = pSnap->data[i];
+      lval   = in_be32((volatile void *)ptr);
+      if (lval != word.l) {
+        word.l = lval;
+        pSnap->data[i] = word.f;
+        changed = 1;
+      }
+    }
+    for (i=0,ptr=(volatile uint32_t *)pVSAM->range; i<VSAM_NUM_CHANS/4; i++,ptr++) {
+      lval = in_be32((volatile void *)ptr);
+      changed |= (lval != pSnap->range[i]);
+      pSnap->range[i] = lval;
+    }
+    for (i=0,ptr=(volatile uint32_t *)pVSAM->ac; i<VSAM_NUM_CHANS/2; i++,ptr++) {
+      lval = in_be32((volatile void *)ptr);
+      changed |= (lval != pSnap->ac[i]);
+      pSnap->ac[i] = lval;
+    }
+    lval = in_be32((volatile void *)&pVSAM->status);
+    changed |= (lval != pSnap->status);
+    pSnap->status = lval;
+    epicsTimeGetCurrent(&pSnap->time);
+    pSnap->count++;
+    return(changed);
+}
+
+/*
+ * VSAM_poll_config - read a card from a thread of its own.
+ *
+ * Call before iocInit. The thread reads the card every period seconds,
+ * or every fast_period seconds while the card is in fast scan mode
+ * (0 to use period), and processes the card's I/O Intr records when
+ * something has changed. The ai records then never touch the card.
+ */
+int VSAM_poll_config( short card, double period, double fast_period )
+{
+    VSAM_ID  pcard = VSAM_getByCard( card );
+
+    if ( !pcard ) {
+      errlogPrintf("VSAM_poll_config: card %hd not configured\n", card);
+      return(ERROR);
+    }
+    if ( period <= 0.0 || fast_period < 0.0 ) {
+      errlogPrintf("VSAM_poll_config: card %hd needs a period > 0\n", card);
+      return(ERROR);
+    }
+    pcard->period      = period;
+    pcard->fast_period = (fast_period > 0.0) ? fast_period : period;
+    return(OK);
+}
+
+static void VSAM_pollTask( void *parg )
+{
+    VSAM_ID  pcard = (VSAM_ID)parg;
+    int      changed;
+    int      fast;
+
+    for (;;) {
+      epicsMutexMustLock(pcard->lock);
+      changed = VSAM_readSnap( pcard );
+      fast    = (pcard->snap.status & FAST_SCAN_MODE) != 0;
+      epicsMutexUnlock(pcard->lock);
+      pcard->polls++;
+      if (changed) {
+        pcard->posts++;
+        scanIoRequest(pcard->ioscan);
+      }
+      epicsThreadSleep(fast ? pcard->fast_period : pcard->period);
+    }
+}
+
+/*
+ * VSAM_snapshot - read the card now and process its I/O Intr records.
+ */
+int VSAM_snapshot( short card )
+{
+    VSAM_ID  pcard = VSAM_getByCard( card );
+
+    if ( !pcard || !pcard->present ) return(ERROR);
+    epicsMutexMustLock(pcard->lock);
+    VSAM_readSnap( pcard );
+    epicsMutexUnlock(pcard->lock);
+    scanIoRequest(pcard->ioscan);
+    return(OK);
+}
+
+/*
+ * VSAM_get_ioscan - I/O Intr scan list of a card
+ */
+int VSAM_get_ioscan( short card, IOSCANPVT *ppvt )
+{
+    VSAM_ID  pcard = VSAM_getByCard( card );
+
+    if ( !pcard || !pcard->present ) return(ERROR);
+    *ppvt = pcard->ioscan;
+    return(OK);
+}
+
+/*
+ * VSAM_lockSnap - take the card's lock, reading the card first
+ *                 if the snapshot is too old to serve a record.
+ */
+static void VSAM_lockSnap( VSAM_ID pcard )
+{
+    VSAMSNAP        *pSnap = &pcard->snap;
+    epicsTimeStamp   now;
+
+    epicsMutexMustLock(pcard->lock);
+    epicsTimeGetCurrent(&now);
+    if ( !pcard->poll_tid && 
+         (!pSnap->count || epicsTimeDiffInSeconds(&now,&pSnap->time) > VSAM_SNAP_AGE) )
+      VSAM_readSnap( pcard );
+}
+
 /*
  * ai_VSAM_read - Read floating point value:
  *			analog data or firmware revision number,
  *			value represented by range byte,
  *			or value represented by AC measurement (short).
+ *
+ * Values come from the card's snapshot, so the records of one scan
+ * see the same pass over the card. Unless the card has a poll thread
+ * the snapshot is read again here when it is older than VSAM_SNAP_AGE;
+ * I/O Intr records are only processed by VSAM_snapshot() and the
+ * poll thread.
  */
 int ai_VSAM_read( short	    card,
                   short	    channel,
@@ -571,49 +783,111 @@ int ai_VSAM_read( short	    card,
     float	     rfloat;
     double	     dfactor,
 	             dpp;
-    VSAMMEM         *pVSAM;
+    VSAM_ID          pcard = NULL;
+    VSAMSNAP        *pSnap = NULL;
 
 
-    status = VSAM_get_adrs( card,&pVSAM );
-    if ( status ==OK ) {
+    pcard = VSAM_getByCard( card );
+    if ( !pcard || !pcard->present ) return(ERROR);
+
+    pSnap = &pcard->snap;
+    VSAM_lockSnap( pcard );
 
-      /* VSAM is D32 only, so bytes and shorts must be extracted here */
-      switch ((int)type) {
+    switch ((int)type) {
 	case RANGE_TYPE:
-	    return(getVSAMRange(pVSAM, ppvt, prval));
+	    status = getVSAMRange(pSnap, ppvt, prval);
 	    break;
 
 	case AC_TYPE:
    	    /* AC peak-to-peak voltage is ranges[range]*ac/(2**14)     */
 	    /* no AC info unless normal scan and analog data requested */
-	    if (pVSAM->status & (FAST_SCAN_MODE|FIRMWARE_REV)) return(-1);
+	    if (pSnap->status & (FAST_SCAN_MODE|FIRMWARE_REV)) {
+	      status = -1;
+	      break;
+	    }
 
 	    /* first get range... */
-	    if (getVSAMRange(pVSAM, ppvt->prange, &rfloat) != 0) return(-1);
+	    if (getVSAMRange(pSnap, ppvt->prange, &rfloat) != 0) {
+	      status = -1;
+	      break;
+	    }
 
 	    dfactor = (double)rfloat/(double)AC_DIVISOR;
 
 	    /* now get AC measurement */
-	    rlong  = in_be32((volatile void *)&pVSAM->ac[ppvt->lchan]);
+	    rlong  = pSnap->ac[ppvt->lchan/2];
 	    rshort = (short)((rlong & ppvt->mask) >> ppvt->shift);
 	    dpp    = dfactor * (double)rshort;
 	    *prval = (float)dpp;
 	    break;
 
 	default:
-	    /* rfloat = (float)in_be32((volatile void *)&pVSAM->data[channel]); */ /* This line is incorrect?  Dereferencing a float as a uint32_t. */
-	    rfloat = pVSAM->data[channel]; /* pVSAM->data[channel] is already a float */
-	    *prval = rfloat; 
+	    *prval = pSnap->data[channel];
 	    break;
+    }
+    epicsMutexUnlock(pcard->lock);
+    return(status);
+}
+
+/*
+ * wf_VSAM_read - Read one value per channel, channels 0..nelm-1,
+ *                from the same snapshot:
+ *			analog data,
+ *			range of each channel (volts),
+ *			or AC peak-to-peak of each channel (volts).
+ *
+ * Returns -1 if there is no AC data in the card's present mode, or
+ * -2 if a range byte is bad; those channels read 0.
+ */
+int wf_VSAM_read( short	    card,
+                  char      type,
+                  float    *pbuf,
+                  int       nelm)
+{
+    int              status = OK;
+    short            chan;
+    short	     rshort;
+    float	     rfloat;
+    VSAMPVT         *ppvt;
+    VSAM_ID          pcard = NULL;
+    VSAMSNAP        *pSnap = NULL;
+
+
+    pcard = VSAM_getByCard( card );
+    if ( !pcard || !pcard->present ) return(ERROR);
+    if ( nelm > VSAM_NUM_CHANS ) nelm = VSAM_NUM_CHANS;
+
+    pSnap = &pcard->snap;
+    VSAM_lockSnap( pcard );
+    if ( type==AC_TYPE && (pSnap->status & (FAST_SCAN_MODE|FIRMWARE_REV)) ) {
+      memset(pbuf, 0, nelm*sizeof(float));
+      status = -1;
+    }
+    else for (chan=0; chan<nelm; chan++) {
+      if ( type==DATA_TYPE ) {
+        pbuf[chan] = pSnap->data[chan];
+        continue;
+      }
+      ppvt = &VSAM_pvt_table[VSAM_PVT_AC][chan];
+      if (getVSAMRange(pSnap, ppvt->prange, &rfloat) != 0) {
+        pbuf[chan] = 0.0;
+        status = -2;
+      }
+      else if ( type==RANGE_TYPE )
+        pbuf[chan] = rfloat;
+      else {
+        rshort = (short)((pSnap->ac[ppvt->lchan/2] & ppvt->mask) >> ppvt->shift);
+        pbuf[chan] = (float)((double)rfloat/(double)AC_DIVISOR*(double)rshort);
       }
     }
+    epicsMutexUnlock(pcard->lock);
     return(status);
 }
 
 /*
  * getVSAMRange - derive floating-point range value for channel
  */
-int getVSAMRange( VSAMMEM  *pMem,
+int getVSAMRange( VSAMSNAP *pSnap,
                   VSAMPVT  *ppvt,
                   float	   *pval)
 {
@@ -623,7 +897,7 @@ int getVSAMRange( VSAMMEM  *pMem,
                                      0.32,  0.16, 0.08, 0.04, 0.02, 
                                      0.01 };
 
-    rlong = in_be32((volatile void *) &pMem->range[ppvt->lchan] );
+    rlong = pSnap->range[ppvt->lchan/4];
     i_range = (char)((rlong & ppvt->mask) >> ppvt->shift);
     if ( i_range>MAX_RANGE_BYTE ) 
       status = -1;
@@ -731,8 +1005,12 @@ long VSAM_io_report( char level )
 
     for(pcard=(VSAM_ID)ellFirst((ELLLIST *)&VSAM_card_list); pcard; pcard = (VSAM_ID)ellNext((ELLNODE *)pcard))
     {
-      if (level == 0 )
+      if (level == 0 ) {
 	 printf("VSAM:\tcard %hd\tA24: 0x%06lx\n", pcard->card, (unsigned long)pcard->bus_addr);
+	 if (pcard->poll_tid)
+	   printf("\tpoll %g s (fast %g s): %lu passes, %lu with new data\n",
+                  pcard->period, pcard->fast_period, pcard->polls, pcard->posts);
+      }
        else if (level == 1) 
 	  VSAM_rval_report(pcard->card,0);
        else if (level==2)